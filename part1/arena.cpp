@@ -0,0 +1,98 @@
+#include "arena.h"
+#include <new>
+#include <cstdint>
+#include <algorithm>
+
+namespace {
+
+// Room for aligning every buffer handed out from a reserved block.
+const size_t kAlignmentSlack = 64;
+
+} // namespace
+
+Arena::Arena(size_t blockSize) : blockSize(blockSize), current(0), offset(0) {
+    counters.allocations = 0;
+    counters.heapAllocations = 0;
+    counters.capacityBytes = 0;
+    counters.peakBytes = 0;
+}
+
+Arena::~Arena() {
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        ::operator delete(blocks[i].data);
+    }
+}
+
+void Arena::addBlock(size_t size) {
+    Block block;
+    block.data = static_cast<char*>(::operator new(size));
+    block.size = size;
+    blocks.push_back(block);
+    counters.heapAllocations++;
+    counters.capacityBytes += size;
+}
+
+void* Arena::allocate(size_t bytes, size_t alignment) {
+    while (true) {
+        if (current < blocks.size()) {
+            const Block& block = blocks[current];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+            uintptr_t aligned = (base + offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+            size_t end = static_cast<size_t>(aligned - base) + bytes;
+            if (end <= block.size) {
+                offset = end;
+                counters.allocations++;
+                counters.peakBytes = std::max(counters.peakBytes, bytesInUse());
+                return reinterpret_cast<void*>(aligned);
+            }
+            if (current + 1 < blocks.size()) {
+                ++current;
+                offset = 0;
+                continue;
+            }
+        }
+        addBlock(std::max(blockSize, bytes + alignment));
+        current = blocks.size() - 1;
+        offset = 0;
+    }
+}
+
+void Arena::reset() {
+    current = 0;
+    offset = 0;
+}
+
+void Arena::reserve(size_t bytes) {
+    reset();
+    size_t needed = bytes + kAlignmentSlack;
+    if (!blocks.empty() && blocks[0].size >= needed) return;
+
+    // The first block is the one every level starts bumping from, so replace
+    // all blocks with a single one that is big enough on its own.
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        counters.capacityBytes -= blocks[i].size;
+        ::operator delete(blocks[i].data);
+    }
+    blocks.clear();
+    addBlock(std::max(blockSize, needed));
+}
+
+size_t Arena::bytesInUse() const {
+    if (blocks.empty()) return 0;
+    size_t used = offset;
+    for (size_t i = 0; i < current; ++i) used += blocks[i].size;
+    return used;
+}
+
+void Arena::resetPeak() {
+    counters.peakBytes = bytesInUse();
+}
+
+Arena::Stats Arena::stats() const {
+    return counters;
+}
+
+Arena& Arena::forThisThread() {
+    thread_local Arena arena;
+    return arena;
+}
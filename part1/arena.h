@@ -0,0 +1,76 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+// Monotonic bump allocator for short-lived scratch buffers.
+// Memory is only returned to the arena as a whole (reset) or back to a saved
+// position (Scope); blocks obtained from the heap are kept and reused, so once
+// an arena has grown to its working size it stops touching the heap.
+// Objects placed in an arena are never destroyed; use it for plain data only.
+class Arena {
+public:
+    struct Stats {
+        size_t allocations;     // buffers handed out
+        size_t heapAllocations; // blocks obtained from the heap
+        size_t capacityBytes;   // total size of all blocks
+        size_t peakBytes;       // highest number of bytes in use at once
+    };
+
+    // Rewinds the arena to where it was when the scope was opened.
+    class Scope {
+    public:
+        explicit Scope(Arena& arena) : arena(arena), block(arena.current), offset(arena.offset) {}
+        ~Scope() { arena.current = block; arena.offset = offset; }
+    private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+        Arena& arena;
+        size_t block;
+        size_t offset;
+    };
+
+    explicit Arena(size_t blockSize = 64 * 1024);
+    ~Arena();
+
+    void* allocate(size_t bytes, size_t alignment);
+
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Frees everything allocated so far; the blocks are kept for reuse.
+    void reset();
+    // Resets the arena and makes sure its first block can hold `bytes`
+    // (plus alignment padding) without going back to the heap.
+    void reserve(size_t bytes);
+    // Starts peakBytes over from what is in use now, so it can be read per search.
+    void resetPeak();
+    Stats stats() const;
+
+    // Arena owned by the calling thread, for scratch memory that does not
+    // outlive the current call.
+    static Arena& forThisThread();
+
+private:
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    void addBlock(size_t size);
+    size_t bytesInUse() const;
+
+    size_t blockSize;
+    std::vector<Block> blocks;
+    size_t current; // index of the block being bumped
+    size_t offset;  // bytes used in blocks[current]
+    Stats counters;
+};
+
+#endif // ARENA_H
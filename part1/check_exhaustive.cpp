@@ -0,0 +1,82 @@
+// Checks that exhaustive search scores every subset exactly as
+// nnLeaveOneOutCV does, and that early abandoning finds the same best subsets.
+// Usage: check_exhaustive <data file>...  (.csv files are read like the
+// diabetes dataset, anything else like the CS205 text files)
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include "knn_utils.h"
+#include "feature_selector.h"
+#include "result_sink.h"
+
+namespace {
+
+// Keeps every scored subset. exhaustiveSearch never emits concurrently.
+class CandidateRecorder : public ResultSink {
+public:
+    void emit(const SearchEvent& event) {
+        if (event.type != SearchEvent::CandidateEvaluated || event.abandoned) return;
+        candidates.push_back(std::make_pair(std::vector<int>(event.features.begin(), event.features.end()),
+                                            event.accuracy));
+    }
+    std::vector<std::pair<std::vector<int>, double> > candidates;
+};
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <data file>..." << std::endl;
+        return 2;
+    }
+
+    bool ok = true;
+    for (int a = 1; a < argc; ++a) {
+        std::string file = argv[a];
+        std::pair<std::vector<std::vector<double> >, std::vector<int> > data;
+        try {
+            data = endsWith(file, ".csv") ? KNNUtils::loadCSVData(file) : KNNUtils::loadData(file);
+        } catch (const std::exception& e) {
+            std::cerr << file << ": " << e.what() << std::endl;
+            return 2;
+        }
+        const std::vector<std::vector<double> >& X = data.first;
+        const std::vector<int>& y = data.second;
+
+        CandidateRecorder recorder;
+        std::vector<std::pair<std::vector<int>, double> > best = FeatureSelector::exhaustiveSearch(X, y, recorder);
+
+        size_t mismatches = 0;
+        std::vector<double> projected;
+        for (size_t c = 0; c < recorder.candidates.size(); ++c) {
+            const std::vector<int>& features = recorder.candidates[c].first;
+            projected.clear();
+            for (size_t i = 0; i < X.size(); ++i) {
+                for (size_t j = 0; j < features.size(); ++j) projected.push_back(X[i][features[j]]);
+            }
+            double expected = KNNUtils::nnLeaveOneOutCV(&projected[0], X.size(), features.size(), y);
+            if (expected != recorder.candidates[c].second) {
+                if (mismatches++ < 10) {
+                    std::cerr << file << ": subset of size " << features.size() << " scored "
+                              << recorder.candidates[c].second << ", nnLeaveOneOutCV gives " << expected << std::endl;
+                }
+            }
+        }
+
+        CandidateRecorder ignored;
+        std::vector<std::pair<std::vector<int>, double> > abandoning =
+            FeatureSelector::exhaustiveSearch(X, y, ignored, true);
+        bool sameBest = abandoning == best;
+
+        std::cout << file << ": " << recorder.candidates.size() << " subsets scored, " << mismatches
+                  << " differ from nnLeaveOneOutCV; early abandoning "
+                  << (sameBest ? "finds the same best subsets" : "finds DIFFERENT best subsets") << std::endl;
+        ok = ok && mismatches == 0 && sameBest;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,504 @@
+#include "data_loader.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+struct Span {
+    const char* begin;
+    const char* end;
+};
+
+struct Line {
+    Span text;
+    size_t number; // 1-based line number in the file, for error messages
+};
+
+const size_t kHeaderSampleRows = 20;
+// A column this much numeric is taken to be numeric with a few bad cells,
+// rather than categorical.
+const double kNumericColumnShare = 0.9;
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Strips surrounding whitespace and one pair of double quotes.
+Span trim(Span s) {
+    while (s.begin < s.end && isBlank(*s.begin)) ++s.begin;
+    while (s.end > s.begin && isBlank(s.end[-1])) --s.end;
+    if (s.end - s.begin >= 2 && *s.begin == '"' && s.end[-1] == '"') {
+        ++s.begin;
+        --s.end;
+    }
+    return s;
+}
+
+bool equalsIgnoreCase(Span s, const char* word) {
+    size_t len = std::strlen(word);
+    if (static_cast<size_t>(s.end - s.begin) != len) return false;
+    for (size_t i = 0; i < len; ++i) {
+        if (std::tolower(static_cast<unsigned char>(s.begin[i])) != word[i]) return false;
+    }
+    return true;
+}
+
+// Expects a trimmed field.
+bool isMissing(Span s) {
+    return s.begin == s.end || equalsIgnoreCase(s, "?") || equalsIgnoreCase(s, "na") ||
+           equalsIgnoreCase(s, "n/a") || equalsIgnoreCase(s, "nan") || equalsIgnoreCase(s, "null");
+}
+
+// Expects a trimmed field. Fields never end in a character that could
+// continue a number (delimiter, quote, whitespace or the end of the buffer),
+// so strtod cannot read past s.end. Only finite decimal numbers count;
+// "inf", overflowing exponents and hex ("0x10") are left as text, since they
+// would make distances infinite or mean something the file did not intend.
+bool parseNumber(Span s, double& out) {
+    if (s.begin == s.end) return false;
+    if (std::find(s.begin, s.end, 'x') != s.end || std::find(s.begin, s.end, 'X') != s.end) return false;
+    char* stop;
+    out = std::strtod(s.begin, &stop);
+    return stop == s.end && std::isfinite(out);
+}
+
+// Splits one line into untrimmed fields. Stops after maxFields fields when
+// maxFields is non-zero, so the rest of a wide line is never scanned.
+void splitLine(Span line, char delimiter, size_t maxFields, std::vector<Span>& fields) {
+    fields.clear();
+    const char* p = line.begin;
+    const char* end = line.end;
+
+    if (delimiter == ' ') {
+        while (true) {
+            while (p < end && isBlank(*p)) ++p;
+            if (p == end) return;
+            Span field = {p, p};
+            while (p < end && !isBlank(*p)) ++p;
+            field.end = p;
+            fields.push_back(field);
+            if (maxFields && fields.size() == maxFields) return;
+        }
+    }
+
+    while (true) {
+        const char* q = p;
+        while (q < end && *q == ' ') ++q;
+        if (q < end && *q == '"') {
+            // Skip over a quoted value, which may contain the delimiter ("" is an escaped quote).
+            for (++q; q < end; ++q) {
+                if (*q == '"') {
+                    if (q + 1 < end && q[1] == '"') ++q;
+                    else { ++q; break; }
+                }
+            }
+        }
+        const char* next = static_cast<const char*>(std::memchr(q, delimiter, end - q));
+        Span field = {p, next ? next : end};
+        fields.push_back(field);
+        if (!next || (maxFields && fields.size() == maxFields)) return;
+        p = next + 1;
+    }
+}
+
+std::vector<Line> splitLines(const std::string& data) {
+    std::vector<Line> lines;
+    const char* p = data.data();
+    const char* end = p + data.size();
+    if (end - p >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3; // UTF-8 byte order mark
+    size_t number = 0;
+    while (p < end) {
+        ++number;
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = newline ? newline : end;
+        Line line = {{p, lineEnd}, number};
+        if (lineEnd > p && lineEnd[-1] == '\r') --line.text.end;
+        if (trim(line.text).begin != trim(line.text).end) lines.push_back(line);
+        p = newline ? newline + 1 : end;
+    }
+    return lines;
+}
+
+char detectDelimiter(Span firstLine) {
+    static const char candidates[] = {',', '\t', ';', '|'};
+    char best = ' ';
+    long bestCount = 0;
+    for (size_t i = 0; i < sizeof(candidates); ++i) {
+        long count = std::count(firstLine.begin, firstLine.end, candidates[i]);
+        if (count > bestCount) {
+            bestCount = count;
+            best = candidates[i];
+        }
+    }
+    return best;
+}
+
+// Number of columns in the file, taken from the first line. A delimiter at
+// the end of every line (as in "a,b,c,") does not start another column.
+size_t countColumns(const std::vector<Line>& lines, char delimiter) {
+    std::vector<Span> fields;
+    splitLine(lines[0].text, delimiter, 0, fields);
+    size_t numColumns = fields.size();
+    if (delimiter == ' ' || numColumns < 2 || !isMissing(trim(fields.back()))) return numColumns;
+
+    for (size_t r = 1; r < lines.size() && r <= kHeaderSampleRows; ++r) {
+        splitLine(lines[r].text, delimiter, numColumns, fields);
+        if (fields.size() == numColumns && !isMissing(trim(fields.back()))) return numColumns;
+    }
+    return numColumns - 1;
+}
+
+enum CellKind { MISSING_CELL, NUMBER_CELL, TEXT_CELL };
+
+CellKind cellKind(Span field) {
+    double number;
+    if (isMissing(field)) return MISSING_CELL;
+    return parseNumber(field, number) ? NUMBER_CELL : TEXT_CELL;
+}
+
+// The first line is a header if it has text where the rows below it only have
+// numbers, so names that look like numbers ("2020") are fine as long as some
+// other column gives the header away. If every column below is categorical,
+// the first line is a header when it has no numbers or blanks and none of its
+// values show up again in the rows below it.
+bool detectHeader(const std::vector<Line>& lines, char delimiter, size_t numColumns) {
+    std::vector<Span> first;
+    splitLine(lines[0].text, delimiter, numColumns, first);
+    if (lines.size() == 1) {
+        for (size_t c = 0; c < first.size(); ++c) {
+            if (cellKind(trim(first[c])) != TEXT_CELL) return false;
+        }
+        return true;
+    }
+
+    // Per column: whether the sampled rows had any number / any text in it.
+    std::vector<bool> numbersBelow(first.size(), false);
+    std::vector<bool> textBelow(first.size(), false);
+    std::vector<Span> fields;
+    bool valuesRepeat = false;
+    for (size_t r = 1; r < lines.size() && r <= kHeaderSampleRows; ++r) {
+        splitLine(lines[r].text, delimiter, first.size(), fields);
+        for (size_t c = 0; c < fields.size(); ++c) {
+            Span field = trim(fields[c]);
+            CellKind kind = cellKind(field);
+            if (kind == NUMBER_CELL) numbersBelow[c] = true;
+            if (kind == TEXT_CELL) textBelow[c] = true;
+            Span name = trim(first[c]);
+            if (field.end - field.begin == name.end - name.begin &&
+                std::equal(field.begin, field.end, name.begin)) {
+                valuesRepeat = true;
+            }
+        }
+    }
+
+    bool anyNumericColumn = false;
+    bool firstLineAllText = true;
+    for (size_t c = 0; c < first.size(); ++c) {
+        CellKind kind = cellKind(trim(first[c]));
+        bool numericColumn = numbersBelow[c] && !textBelow[c];
+        if (kind == TEXT_CELL && numericColumn) return true;
+        anyNumericColumn = anyNumericColumn || numericColumn;
+        firstLineAllText = firstLineAllText && kind == TEXT_CELL;
+    }
+    return !anyNumericColumn && firstLineAllText && !valuesRepeat;
+}
+
+std::string columnLabel(size_t index) {
+    std::ostringstream os;
+    os << "column " << index + 1;
+    return os.str();
+}
+
+int findColumn(const std::vector<std::string>& names, const std::string& name) {
+    std::vector<std::string>::const_iterator it = std::find(names.begin(), names.end(), name);
+    if (it == names.end()) {
+        throw std::runtime_error("no column named '" + name + "'");
+    }
+    return static_cast<int>(it - names.begin());
+}
+
+int resolveColumn(int column, size_t numColumns) {
+    int resolved = column < 0 ? static_cast<int>(numColumns) + column : column;
+    if (resolved < 0 || resolved >= static_cast<int>(numColumns)) {
+        std::ostringstream msg;
+        msg << "column index " << column << " (0-based) is out of range for " << numColumns << " columns";
+        throw std::runtime_error(msg.str());
+    }
+    return resolved;
+}
+
+bool isNaN(double v) {
+    return v != v;
+}
+
+// Converts one column of trimmed fields. Missing values become NaN.
+// Returns true if every present value was a number, otherwise numbers the
+// distinct values in order of first appearance and lists them in categories.
+// A column that is almost all
+// numbers is most likely numeric with a typo in it, so instead of silently
+// making it categorical, badRow is set to the first cell that is not a number
+// (it is cells.size() otherwise).
+bool convertColumn(const std::vector<Span>& cells, std::vector<double>& values, size_t& badRow,
+                   std::vector<std::string>& categories) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    values.resize(cells.size());
+    badRow = cells.size();
+    size_t numbers = 0;
+    size_t present = 0;
+    for (size_t r = 0; r < cells.size(); ++r) {
+        if (isMissing(cells[r])) {
+            values[r] = nan;
+            continue;
+        }
+        ++present;
+        if (parseNumber(cells[r], values[r])) ++numbers;
+        else if (badRow == cells.size()) badRow = r;
+    }
+    if (numbers == present) return true;
+    if (numbers >= kNumericColumnShare * present) return false;
+    badRow = cells.size();
+
+    std::unordered_map<std::string, int> codes;
+    for (size_t r = 0; r < cells.size(); ++r) {
+        if (isMissing(cells[r])) {
+            values[r] = nan;
+            continue;
+        }
+        std::string key(cells[r].begin, cells[r].end);
+        std::unordered_map<std::string, int>::iterator it = codes.find(key);
+        if (it == codes.end()) {
+            it = codes.insert(std::make_pair(key, static_cast<int>(codes.size()))).first;
+            categories.push_back(key);
+        }
+        values[r] = it->second;
+    }
+    return false;
+}
+
+// Whether every present value fits in an int class label as it is.
+bool integerValued(const std::vector<double>& values) {
+    for (size_t r = 0; r < values.size(); ++r) {
+        double v = values[r];
+        if (isNaN(v)) continue;
+        if (v != std::floor(v) || v < std::numeric_limits<int>::min() || v > std::numeric_limits<int>::max()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Numbers the distinct present values in order of first appearance.
+void numberDistinct(std::vector<double>& values) {
+    std::vector<double> seen;
+    for (size_t r = 0; r < values.size(); ++r) {
+        if (isNaN(values[r])) continue;
+        std::vector<double>::iterator it = std::find(seen.begin(), seen.end(), values[r]);
+        if (it == seen.end()) it = seen.insert(seen.end(), values[r]);
+        values[r] = static_cast<double>(it - seen.begin());
+    }
+}
+
+// Value used in place of missing entries, computed over the kept rows.
+double fillValue(const std::vector<double>& values, const std::vector<bool>& keep,
+                 bool categorical, LoadOptions::MissingValues policy) {
+    std::vector<double> present;
+    for (size_t r = 0; r < values.size(); ++r) {
+        if (keep[r] && !isNaN(values[r])) present.push_back(values[r]);
+    }
+    if (present.empty()) return 0.0;
+
+    if (categorical) {
+        // Most frequent category; codes are small non-negative integers.
+        std::vector<size_t> counts;
+        for (size_t i = 0; i < present.size(); ++i) {
+            size_t code = static_cast<size_t>(present[i]);
+            if (code >= counts.size()) counts.resize(code + 1, 0);
+            counts[code]++;
+        }
+        return static_cast<double>(std::max_element(counts.begin(), counts.end()) - counts.begin());
+    }
+    if (policy == LoadOptions::IMPUTE_MEDIAN) {
+        size_t mid = present.size() / 2;
+        std::nth_element(present.begin(), present.begin() + mid, present.end());
+        double median = present[mid];
+        if (present.size() % 2 == 0) {
+            median = (median + *std::max_element(present.begin(), present.begin() + mid)) / 2;
+        }
+        return median;
+    }
+    double sum = 0;
+    for (size_t i = 0; i < present.size(); ++i) sum += present[i];
+    return sum / present.size();
+}
+
+} // namespace
+
+LoadedData DataLoader::load(const std::string& filename, const LoadOptions& options) {
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("could not open '" + filename + "'");
+    }
+    std::string data;
+    file.seekg(0, std::ios::end);
+    data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    if (!data.empty() && !file.read(&data[0], data.size())) {
+        throw std::runtime_error("could not read '" + filename + "'");
+    }
+
+    LoadedData result;
+    result.delimiter = options.delimiter;
+    result.hasHeader = false;
+    result.droppedRows = 0;
+    result.imputedValues = 0;
+    result.categoricalColumns = 0;
+
+    std::vector<Line> lines = splitLines(data);
+    if (lines.empty()) return result;
+
+    char delimiter = options.delimiter ? options.delimiter : detectDelimiter(lines[0].text);
+    size_t numColumns = countColumns(lines, delimiter);
+    bool hasHeader = options.header < 0 ? detectHeader(lines, delimiter, numColumns) : options.header > 0;
+    result.delimiter = delimiter;
+    result.hasHeader = hasHeader;
+
+    // Column names come from the first line, header or not.
+    std::vector<Span> fields;
+    splitLine(lines[0].text, delimiter, numColumns, fields);
+    std::vector<std::string> names(numColumns);
+    for (size_t c = 0; c < numColumns; ++c) {
+        Span name = trim(fields[c]);
+        names[c] = hasHeader ? std::string(name.begin, name.end) : columnLabel(c);
+    }
+
+    if ((!options.labelName.empty() || !options.featureNames.empty()) && !hasHeader) {
+        throw std::runtime_error("columns can only be selected by name in files with a header");
+    }
+    int labelColumn = options.labelName.empty() ? resolveColumn(options.labelColumn, numColumns)
+                                                : findColumn(names, options.labelName);
+    std::vector<int> featureColumns;
+    if (!options.featureNames.empty()) {
+        for (size_t i = 0; i < options.featureNames.size(); ++i) {
+            featureColumns.push_back(findColumn(names, options.featureNames[i]));
+        }
+    } else if (!options.featureColumns.empty()) {
+        for (size_t i = 0; i < options.featureColumns.size(); ++i) {
+            featureColumns.push_back(resolveColumn(options.featureColumns[i], numColumns));
+        }
+    } else {
+        for (size_t c = 0; c < numColumns; ++c) {
+            if (static_cast<int>(c) != labelColumn) featureColumns.push_back(static_cast<int>(c));
+        }
+    }
+    if (std::find(featureColumns.begin(), featureColumns.end(), labelColumn) != featureColumns.end()) {
+        throw std::runtime_error("column '" + names[labelColumn] + "' cannot be both the label and a feature");
+    }
+
+    // Only the requested columns are kept, one contiguous run of cells per
+    // column; the label goes last.
+    std::vector<int> wanted = featureColumns;
+    wanted.push_back(labelColumn);
+    size_t maxFields = static_cast<size_t>(*std::max_element(wanted.begin(), wanted.end())) + 1;
+    size_t firstRow = hasHeader ? 1 : 0;
+    size_t numRows = lines.size() - firstRow;
+    std::vector<std::vector<Span> > cells(wanted.size(), std::vector<Span>(numRows));
+    for (size_t r = 0; r < numRows; ++r) {
+        const Line& line = lines[firstRow + r];
+        splitLine(line.text, delimiter, maxFields, fields);
+        if (fields.size() < maxFields) {
+            std::ostringstream msg;
+            msg << filename << ":" << line.number << ": expected at least " << maxFields
+                << " columns, found " << fields.size();
+            throw std::runtime_error(msg.str());
+        }
+        for (size_t k = 0; k < wanted.size(); ++k) {
+            cells[k][r] = trim(fields[wanted[k]]);
+        }
+    }
+
+    std::vector<std::vector<double> > columns(wanted.size());
+    std::vector<bool> categorical(wanted.size());
+    std::vector<std::vector<std::string> > categories(wanted.size());
+    for (size_t k = 0; k < wanted.size(); ++k) {
+        size_t badRow;
+        categorical[k] = !convertColumn(cells[k], columns[k], badRow, categories[k]);
+        if (badRow < numRows) {
+            std::ostringstream msg;
+            msg << filename << ":" << lines[firstRow + badRow].number << ": '"
+                << std::string(cells[k][badRow].begin, cells[k][badRow].end) << "' in column '"
+                << names[wanted[k]] << "' is not a number, but nearly all of the column is";
+            throw std::runtime_error(msg.str());
+        }
+    }
+    // Numeric labels that are not whole numbers (0.5, 1.7) are class names
+    // too; truncating them would merge classes.
+    if (!categorical.back() && !integerValued(columns.back())) numberDistinct(columns.back());
+    const std::vector<double>& labels = columns.back();
+    size_t numFeatures = featureColumns.size();
+
+    std::vector<bool> keep(numRows, true);
+    for (size_t r = 0; r < numRows; ++r) {
+        bool missingFeature = false;
+        for (size_t k = 0; k < numFeatures && !missingFeature; ++k) {
+            missingFeature = isNaN(columns[k][r]);
+        }
+        if (isNaN(labels[r]) || (missingFeature && options.missing == LoadOptions::DROP_ROW)) {
+            keep[r] = false;
+            result.droppedRows++;
+        }
+    }
+
+    std::vector<double> fill(numFeatures);
+    for (size_t k = 0; k < numFeatures; ++k) {
+        fill[k] = fillValue(columns[k], keep, categorical[k], options.missing);
+    }
+
+    // Categorical columns are one-hot encoded, one 0/1 feature per value, so
+    // two rows are the same distance apart whichever values they differ in.
+    size_t width = 0;
+    for (size_t k = 0; k < numFeatures; ++k) {
+        if (categorical[k]) {
+            result.categoricalColumns++;
+            for (size_t v = 0; v < categories[k].size(); ++v) {
+                result.featureNames.push_back(names[featureColumns[k]] + "=" + categories[k][v]);
+                result.featureTypes.push_back(LoadedData::CATEGORICAL);
+            }
+            width += categories[k].size();
+        } else {
+            result.featureNames.push_back(names[featureColumns[k]]);
+            result.featureTypes.push_back(LoadedData::NUMERIC);
+            width++;
+        }
+    }
+
+    for (size_t r = 0; r < numRows; ++r) {
+        if (!keep[r]) continue;
+        std::vector<double> row(width, 0.0);
+        size_t out = 0;
+        for (size_t k = 0; k < numFeatures; ++k) {
+            double value = columns[k][r];
+            if (isNaN(value)) {
+                value = fill[k];
+                result.imputedValues++;
+            }
+            if (categorical[k]) {
+                row[out + static_cast<size_t>(value)] = 1.0;
+                out += categories[k].size();
+            } else {
+                row[out++] = value;
+            }
+        }
+        result.X.push_back(row);
+        result.y.push_back(static_cast<int>(labels[r]));
+    }
+    result.labelName = names[labelColumn];
+    return result;
+}
@@ -0,0 +1,61 @@
+#ifndef DATA_LOADER_H
+#define DATA_LOADER_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+// How to read a delimited text file into a feature matrix and labels.
+// The defaults detect everything and use the last column as the label.
+struct LoadOptions {
+    enum MissingValues {
+        IMPUTE_MEAN,   // numeric columns get the column mean, categorical the most frequent value
+        IMPUTE_MEDIAN, // numeric columns get the column median, categorical the most frequent value
+        DROP_ROW       // rows with a missing feature are skipped
+    };
+
+    char delimiter;   // '\0' detects ',', '\t', ';' or '|'; ' ' splits on runs of whitespace
+    int header;       // -1 detects, 0 no header line, 1 first line is a header
+    int labelColumn;  // 0-based; negative counts from the end, so -1 is the last column
+    std::string labelName;           // if set (needs a header), overrides labelColumn
+    std::vector<int> featureColumns; // 0-based; empty means every column except the label
+    std::vector<std::string> featureNames; // if set (needs a header), overrides featureColumns
+    MissingValues missing;
+
+    LoadOptions() : delimiter('\0'), header(-1), labelColumn(-1), missing(IMPUTE_MEAN) {}
+};
+
+struct LoadedData {
+    enum ColumnType { NUMERIC, CATEGORICAL };
+
+    std::vector<std::vector<double> > X;
+    std::vector<int> y;
+    std::vector<std::string> featureNames; // from the header, or "column N" (1-based); "name=value" for one-hot features
+    std::vector<ColumnType> featureTypes;  // CATEGORICAL for the one-hot features of a categorical column
+    std::string labelName;
+    char delimiter;        // the delimiter that was used
+    bool hasHeader;
+    size_t droppedRows;    // rows skipped for a missing label (or feature, with DROP_ROW)
+    size_t imputedValues;
+    size_t categoricalColumns; // source columns that were one-hot encoded
+};
+
+// Reads CSV, TSV and whitespace-separated files in one pass over an in-memory
+// copy of the file. Only the label and the requested feature columns are
+// converted; the rest of each line is skipped, and scanning a line stops at
+// the last column that is needed. A feature column whose values are not all
+// numbers is categorical and becomes one 0/1 feature per distinct value, so
+// X can be wider than the number of feature columns. Labels that are not
+// whole numbers (text, or numbers like 0.5) are numbered in order of first
+// appearance. Only finite decimal numbers count as numbers. Blank, "?",
+// "NA", "N/A", "NaN" and "null" fields are missing.
+// A delimiter at the end of every line does not add an empty column.
+// Throws std::runtime_error if the file cannot be read, a row is too short,
+// the label is also selected as a feature, or a column that is nearly all
+// numbers has a few values that are not (reported with their line number).
+class DataLoader {
+public:
+    static LoadedData load(const std::string& filename, const LoadOptions& options = LoadOptions());
+};
+
+#endif // DATA_LOADER_H
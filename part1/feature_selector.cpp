@@ -1,20 +1,244 @@
 #include "feature_selector.h"
 #include "knn_utils.h" // Already included in .h, but good practice for .cpp if directly using its types
-#include <iostream>
 #include <algorithm> // For std::remove, std::iota
 #include <numeric>   // For std::iota (though already in knn_utils.cpp, this makes this unit more self-contained if needed)
 #include <limits>    // For std::numeric_limits
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <stdexcept>
+#include <sstream>
+#include <exception>
+#include <system_error>
+#include "result_sink.h"
+#include "arena.h"
+#include "heap_counter.h"
+
+namespace {
+
+// Copies the given feature columns of every row of X into out, row-major.
+void projectRows(const std::vector<std::vector<double> >& X, const int* features, size_t d, double* out) {
+    for (size_t i = 0; i < X.size(); ++i) {
+        const std::vector<double>& row = X[i];
+        for (size_t j = 0; j < d; ++j) {
+            *out++ = row[features[j]];
+        }
+    }
+}
+
+// Scratch needed by one candidate: its feature list and its projection of X.
+size_t candidateScratchBytes(size_t n, size_t d) {
+    return d * sizeof(int) + n * d * sizeof(double) + alignof(double);
+}
+
+void reportMemory(SearchEvent& finished, const Arena::Stats& before, const Arena::Stats& after,
+                  size_t heapBefore, size_t loopHeapAllocations) {
+    finished.scratchAllocations = after.allocations - before.allocations;
+    finished.scratchPeakBytes = after.peakBytes;
+    finished.heapAllocations = HeapCounter::allocationsOnThisThread() - heapBefore;
+    finished.loopHeapAllocations = loopHeapAllocations;
+}
+
+
+typedef unsigned long long SubsetMask;
+
+int countFeatures(SubsetMask mask) {
+    int count = 0;
+    for (; mask; mask &= mask - 1) ++count;
+    return count;
+}
+
+// State shared by the exhaustive search workers. The subset space is cut into
+// subtrees by fixing which of the lowest `prefixBits` features are in the
+// subset; workers claim whole subtrees and extend them with the remaining
+// `lowBits` features (see walkSubsets).
+struct ExhaustiveSearch {
+    const double* columns; // column-major copy of X, n values per feature
+    size_t n;
+    size_t numFeatures;
+    size_t prefixBits;
+    size_t lowBits;
+    size_t numSubtrees;
+    const std::vector<int>* y;
+    bool earlyAbandon;
+    ResultSink* sink;
+
+    std::atomic<size_t> nextSubtree;
+    std::atomic<size_t> abandoned;
+    std::atomic<bool> failed; // a worker threw; the others stop at their next subtree
+    // Best number of correct predictions seen so far for each subset size;
+    // the cutoff only competes against subsets of the same size, so the best
+    // subset of every size (not just the overall one) is still exact.
+    std::unique_ptr<std::atomic<int>[]> bestCorrect;
+    std::mutex emitMutex;
+};
+
+struct ExhaustiveWorkerResult {
+    std::vector<int> bestCorrect; // per subset size, -1 if none evaluated
+    std::vector<SubsetMask> bestMask;
+    Arena::Stats scratch;       // this worker's arena use
+    size_t heapAllocations;     // made by this worker's thread
+    size_t loopHeapAllocations; // ...of which while walking subsets
+    std::exception_ptr error;
+};
+
+// to = from plus feature f's contribution to the pairwise squared distances
+// of all samples; to may be from. Features are only ever added, highest last,
+// so every distance is summed in exactly the order nnLeaveOneOutCV sums it
+// and the scores match it bit for bit. (Subtracting a feature instead would
+// leave rounding error behind that breaks exact ties.)
+void addFeature(const ExhaustiveSearch& s, const double* from, double* to, size_t f) {
+    const double* col = s.columns + f * s.n;
+    for (size_t i = 0; i < s.n; ++i) {
+        double xi = col[i];
+        const double* in = from + i * s.n;
+        double* out = to + i * s.n;
+        for (size_t j = 0; j < s.n; ++j) {
+            double t = xi - col[j];
+            out[j] = in[j] + t * t;
+        }
+    }
+}
+
+// Leave-one-out 1-NN on the current distance matrix. Returns the number of
+// correct predictions, or -1 once more than maxErrors samples have been
+// misclassified.
+int countCorrect(const ExhaustiveSearch& s, const double* dist, int maxErrors) {
+    const std::vector<int>& y = *s.y;
+    int errors = 0;
+    for (size_t i = 0; i < s.n; ++i) {
+        const double* row = dist + i * s.n;
+        double minDist = std::numeric_limits<double>::max();
+        int predicted = -1;
+        for (size_t j = 0; j < s.n; ++j) {
+            if (i == j) continue;
+            if (row[j] < minDist) {
+                minDist = row[j];
+                predicted = y[j];
+            }
+        }
+        if (predicted != y[i] && ++errors > maxErrors) return -1;
+    }
+    return static_cast<int>(s.n) - errors;
+}
+
+// subset is scratch room for numFeatures indices, used to report the subset.
+void evaluateSubset(ExhaustiveSearch& s, const double* dist, SubsetMask mask, int* subset,
+                    ExhaustiveWorkerResult& result) {
+    int size = countFeatures(mask);
+    int maxErrors = static_cast<int>(s.n);
+    if (s.earlyAbandon) {
+        // Anything with more errors than this cannot even tie the best subset of this size.
+        int best = s.bestCorrect[size].load(std::memory_order_relaxed);
+        if (best >= 0) maxErrors = static_cast<int>(s.n) - best;
+    }
+    int correct = countCorrect(s, dist, maxErrors);
+
+    SearchEvent candidate(SearchEvent::CandidateEvaluated, SearchEvent::Exhaustive);
+    candidate.level = size;
+    size_t d = 0;
+    for (size_t f = 0; f < s.numFeatures; ++f) {
+        if (mask & (SubsetMask(1) << f)) subset[d++] = static_cast<int>(f);
+    }
+    candidate.features = FeatureList(subset, d);
+    if (correct < 0) {
+        s.abandoned++;
+        candidate.abandoned = true;
+        std::lock_guard<std::mutex> lock(s.emitMutex);
+        s.sink->emit(candidate);
+        return;
+    }
+
+    int seen = s.bestCorrect[size].load(std::memory_order_relaxed);
+    while (correct > seen && !s.bestCorrect[size].compare_exchange_weak(seen, correct)) {}
+    if (correct > result.bestCorrect[size] || (correct == result.bestCorrect[size] && mask < result.bestMask[size])) {
+        result.bestCorrect[size] = correct;
+        result.bestMask[size] = mask;
+    }
+
+    candidate.accuracy = static_cast<double>(correct) / s.n;
+    std::lock_guard<std::mutex> lock(s.emitMutex);
+    s.sink->emit(candidate);
+}
+
+// Evaluates every subset that extends `mask` by features from `next` up,
+// each one feature above the last. dist holds the distances for `mask`; the
+// matrix after it receives each child's, so the walk needs one matrix per
+// level below the start.
+void walkSubsets(ExhaustiveSearch& s, const double* dist, SubsetMask mask, size_t next, int* subset,
+                 ExhaustiveWorkerResult& result) {
+    double* child = const_cast<double*>(dist) + s.n * s.n;
+    for (size_t f = next; f < s.numFeatures && !s.failed; ++f) {
+        SubsetMask childMask = mask | (SubsetMask(1) << f);
+        addFeature(s, dist, child, f);
+        evaluateSubset(s, child, childMask, subset, result);
+        walkSubsets(s, child, childMask, f + 1, subset, result);
+    }
+}
+
+void exhaustiveWorker(ExhaustiveSearch& s, ExhaustiveWorkerResult& result) {
+    size_t heapBefore = HeapCounter::allocationsOnThisThread();
+    size_t matrixSize = s.n * s.n;
+    size_t numMatrices = s.lowBits + 1;
+    Arena& arena = Arena::forThisThread();
+    Arena::Stats before = arena.stats();
+    arena.reserve(numMatrices * matrixSize * sizeof(double) + s.numFeatures * sizeof(int) + alignof(double));
+    arena.resetPeak();
+    int* subset = arena.allocateArray<int>(s.numFeatures);
+    double* dists = arena.allocateArray<double>(numMatrices * matrixSize);
+
+    result.bestCorrect.assign(s.numFeatures + 1, -1);
+    result.bestMask.assign(s.numFeatures + 1, 0);
+    result.loopHeapAllocations = 0;
+
+    size_t subtree;
+    while (!s.failed && (subtree = s.nextSubtree++) < s.numSubtrees) {
+        size_t heapBeforeWalk = HeapCounter::allocationsOnThisThread();
+        // The subtree's fixed low features, added in ascending order like every later one.
+        SubsetMask mask = static_cast<SubsetMask>(subtree);
+        std::fill(dists, dists + matrixSize, 0.0);
+        for (size_t f = 0; f < s.prefixBits; ++f) {
+            if (mask & (SubsetMask(1) << f)) addFeature(s, dists, dists, f);
+        }
+        if (mask != 0) evaluateSubset(s, dists, mask, subset, result);
+        walkSubsets(s, dists, mask, s.prefixBits, subset, result);
+        result.loopHeapAllocations += HeapCounter::allocationsOnThisThread() - heapBeforeWalk;
+    }
+
+    Arena::Stats after = arena.stats();
+    result.scratch.allocations = after.allocations - before.allocations;
+    result.scratch.peakBytes = after.peakBytes;
+    result.heapAllocations = HeapCounter::allocationsOnThisThread() - heapBefore;
+}
+
+// Thread entry point: keeps an exception from ending the program, and has the
+// other workers stop early so the caller can rethrow it.
+void runExhaustiveWorker(ExhaustiveSearch& s, ExhaustiveWorkerResult& result) {
+    try {
+        exhaustiveWorker(s, result);
+    } catch (...) {
+        result.error = std::current_exception();
+        s.failed = true;
+    }
+}
+
+} // namespace
+
+const size_t FeatureSelector::kMaxExhaustiveFeatures;
+const size_t FeatureSelector::kMaxExhaustiveScratchBytes;
 
 std::vector<std::pair<std::vector<int>, double>> FeatureSelector::forwardSelection(
-    const std::vector<std::vector<double> >& X, const std::vector<int>& y) {
+    const std::vector<std::vector<double> >& X, const std::vector<int>& y, ResultSink& sink) {
     std::vector<std::pair<std::vector<int>, double>> results;
     
     if (X.empty() || X[0].empty()) {
-        std::cout << "Input data X is empty or has no features. Aborting forward selection." << std::endl;
+        sink.emit(SearchEvent(SearchEvent::SearchAborted, SearchEvent::Forward));
         return results;
     }
     
     size_t numFeatures = X[0].size();
+    size_t heapBefore = HeapCounter::allocationsOnThisThread();
     std::vector<int> allFeatures(numFeatures);
     std::iota(allFeatures.begin(), allFeatures.end(), 0);
     std::vector<int> selectedFeatures;
@@ -22,39 +246,47 @@ std::vector<std::pair<std::vector<int>, double>> FeatureSelector::forwardSelecti
     double globalBestAcc = -1.0;
     std::vector<int> bestFeaturesOverall;
 
-    std::cout << "Beginning forward selection.\n";
+    // All per-candidate buffers come from this thread's arena. The last level
+    // needs the most, so reserving for it up front keeps the loop off the heap.
+    size_t n = X.size();
+    Arena& arena = Arena::forThisThread();
+    Arena::Stats scratchBefore = arena.stats();
+    arena.reserve(candidateScratchBytes(n, numFeatures));
+    arena.resetPeak();
+    size_t loopHeapAllocations = 0;
+
+    sink.emit(SearchEvent(SearchEvent::SearchStarted, SearchEvent::Forward));
 
     for (size_t k = 0; k < numFeatures; ++k) {
-        std::cout << "\nOn level " << k + 1 << " of the search tree\n";
-        std::cout << "Current selected feature set: {";
-        for (size_t i = 0; i < selectedFeatures.size(); ++i) {
-            std::cout << selectedFeatures[i] + 1 << (i == selectedFeatures.size() - 1 ? "" : ", ");
-        }
-        std::cout << "}\n";
+        arena.reset();
+        SearchEvent levelStarted(SearchEvent::LevelStarted, SearchEvent::Forward);
+        levelStarted.level = k + 1;
+        levelStarted.features = FeatureList(selectedFeatures);
+        sink.emit(levelStarted);
 
         double bestLocalAcc = -1.0;
         int featureToAddThisLevel = -1;
 
         for (int f_idx = 0; f_idx < allFeatures.size(); ++f_idx) {
             int featureToConsider = allFeatures[f_idx];
-            std::vector<int> trialFeatures = selectedFeatures;
-            trialFeatures.push_back(featureToConsider);
-            std::sort(trialFeatures.begin(), trialFeatures.end());
-
-            std::vector<std::vector<double> > projectedX;
-            for (const auto& row : X) {
-                std::vector<double> proj;
-                for (int idx : trialFeatures) {
-                    proj.push_back(row[idx]);
-                }
-                projectedX.push_back(proj);
-            }
-            double acc = KNNUtils::nnLeaveOneOutCV(projectedX, y);
-            std::cout << "    Considering adding feature " << featureToConsider + 1 << " with current set {";
-            for(size_t i = 0; i < trialFeatures.size(); ++i) {
-                std::cout << trialFeatures[i] + 1 << (i == trialFeatures.size() - 1 ? "" : ", ");
-            }
-            std::cout << "} accuracy is " << acc * 100 << "%\n";
+            size_t heapBeforeCandidate = HeapCounter::allocationsOnThisThread();
+            Arena::Scope scratch(arena);
+            size_t d = selectedFeatures.size() + 1;
+            int* trialFeatures = arena.allocateArray<int>(d);
+            std::copy(selectedFeatures.begin(), selectedFeatures.end(), trialFeatures);
+            trialFeatures[d - 1] = featureToConsider;
+            std::sort(trialFeatures, trialFeatures + d);
+
+            double* projectedX = arena.allocateArray<double>(n * d);
+            projectRows(X, trialFeatures, d, projectedX);
+            double acc = KNNUtils::nnLeaveOneOutCV(projectedX, n, d, y);
+            SearchEvent candidate(SearchEvent::CandidateEvaluated, SearchEvent::Forward);
+            candidate.level = k + 1;
+            candidate.feature = featureToConsider;
+            candidate.features = FeatureList(trialFeatures, d);
+            candidate.accuracy = acc;
+            sink.emit(candidate);
+            loopHeapAllocations += HeapCounter::allocationsOnThisThread() - heapBeforeCandidate;
 
             if (acc > bestLocalAcc) {
                 bestLocalAcc = acc;
@@ -67,100 +299,112 @@ std::vector<std::pair<std::vector<int>, double>> FeatureSelector::forwardSelecti
             std::sort(selectedFeatures.begin(), selectedFeatures.end());
             allFeatures.erase(std::remove(allFeatures.begin(), allFeatures.end(), featureToAddThisLevel), allFeatures.end());
 
-            std::cout << "\nOn level " << k + 1 << ", added feature " << featureToAddThisLevel + 1 << " to current set. Accuracy: " << bestLocalAcc * 100 << "%\n";
-            std::cout << "Current best feature set: {";
-            for(size_t i = 0; i < selectedFeatures.size(); ++i) {
-                std::cout << selectedFeatures[i] + 1 << (i == selectedFeatures.size() - 1 ? "" : ", ");
-            }
-            std::cout << "} with accuracy " << bestLocalAcc * 100 << "%\n";
-
             // Store the current result
             results.push_back({selectedFeatures, bestLocalAcc});
 
+            SearchEvent levelCompleted(SearchEvent::LevelCompleted, SearchEvent::Forward);
+            levelCompleted.level = k + 1;
+            levelCompleted.feature = featureToAddThisLevel;
+            levelCompleted.features = FeatureList(selectedFeatures);
+            levelCompleted.accuracy = bestLocalAcc;
+            levelCompleted.improved = bestLocalAcc > globalBestAcc;
+            sink.emit(levelCompleted);
+
             if (bestLocalAcc > globalBestAcc) {
                 globalBestAcc = bestLocalAcc;
                 bestFeaturesOverall = selectedFeatures;
-            } else {
-                std::cout << "(Warning, accuracy has decreased or stayed the same. Global best is still better.)\n";
             }
         } else {
-            std::cout << "\nNo feature improved accuracy at this level. Halting forward selection.\n";
+            SearchEvent halted(SearchEvent::SearchHalted, SearchEvent::Forward);
+            halted.level = k + 1;
+            halted.features = FeatureList(selectedFeatures);
+            sink.emit(halted);
             break;
         }
         if (selectedFeatures.size() == numFeatures) break;
     }
 
-    std::cout << "\nFinished forward selection!! The best feature subset is: {";
-    for (size_t i = 0; i < bestFeaturesOverall.size(); ++i) {
-        std::cout << bestFeaturesOverall[i] + 1 << (i == bestFeaturesOverall.size() - 1 ? "" : ", ");
-    }
-    std::cout << "}, which has an accuracy of " << globalBestAcc * 100 << "%\n";
+    SearchEvent finished(SearchEvent::SearchFinished, SearchEvent::Forward);
+    finished.features = FeatureList(bestFeaturesOverall);
+    finished.accuracy = globalBestAcc;
+    reportMemory(finished, scratchBefore, arena.stats(), heapBefore, loopHeapAllocations);
+    sink.emit(finished);
 
     return results;
 }
 
 std::vector<std::pair<std::vector<int>, double>> FeatureSelector::backwardElimination(
-    const std::vector<std::vector<double> >& X, const std::vector<int>& y) {
+    const std::vector<std::vector<double> >& X, const std::vector<int>& y, ResultSink& sink) {
     std::vector<std::pair<std::vector<int>, double>> results;
     
     if (X.empty() || X[0].empty()) {
-        std::cout << "Input data X is empty or has no features. Aborting backward elimination." << std::endl;
+        sink.emit(SearchEvent(SearchEvent::SearchAborted, SearchEvent::Backward));
         return results;
     }
     
     size_t numFeatures = X[0].size();
+    size_t heapBefore = HeapCounter::allocationsOnThisThread();
     std::vector<int> currentFeatures(numFeatures);
     std::iota(currentFeatures.begin(), currentFeatures.end(), 0);
 
-    std::cout << "Calculating initial accuracy with all features.\n";
-    double globalBestAcc = KNNUtils::nnLeaveOneOutCV(X, y);
+    // The full set is the largest projection, so reserving for it up front
+    // keeps the per-candidate buffers below off the heap.
+    size_t n = X.size();
+    Arena& arena = Arena::forThisThread();
+    Arena::Stats scratchBefore = arena.stats();
+    arena.reserve(candidateScratchBytes(n, numFeatures));
+    arena.resetPeak();
+    size_t loopHeapAllocations = 0;
+
+    double* fullX = arena.allocateArray<double>(n * numFeatures);
+    projectRows(X, &currentFeatures[0], numFeatures, fullX);
+    double globalBestAcc = KNNUtils::nnLeaveOneOutCV(fullX, n, numFeatures, y);
     std::vector<int> bestFeaturesOverall = currentFeatures;
 
     // Store initial result
     results.push_back({currentFeatures, globalBestAcc});
 
-    std::cout << "Initial feature set: {";
-    for(size_t i = 0; i < currentFeatures.size(); ++i) {
-        std::cout << currentFeatures[i] + 1 << (i == currentFeatures.size() - 1 ? "" : ", ");
-    }
-    std::cout << "} with accuracy " << globalBestAcc * 100 << "%\n";
-    std::cout << "Beginning backward elimination.\n";
+    SearchEvent started(SearchEvent::SearchStarted, SearchEvent::Backward);
+    started.features = FeatureList(currentFeatures);
+    started.accuracy = globalBestAcc;
+    sink.emit(started);
 
     for (size_t k = 0; k < numFeatures - 1; ++k) {
         if (currentFeatures.size() <= 1) {
-            std::cout << "\nOnly one feature remaining. Halting backward elimination.\n";
+            SearchEvent halted(SearchEvent::SearchHalted, SearchEvent::Backward);
+            halted.level = k + 1;
+            halted.features = FeatureList(currentFeatures);
+            sink.emit(halted);
             break;
         }
-        std::cout << "\nOn level " << k + 1 << " of the search tree\n";
-        std::cout << "Current feature set to evaluate for removal: {";
-        for (size_t i = 0; i < currentFeatures.size(); ++i) {
-            std::cout << currentFeatures[i] + 1 << (i == currentFeatures.size() - 1 ? "" : ", ");
-        }
-        std::cout << "}\n";
+        arena.reset();
+        SearchEvent levelStarted(SearchEvent::LevelStarted, SearchEvent::Backward);
+        levelStarted.level = k + 1;
+        levelStarted.features = FeatureList(currentFeatures);
+        sink.emit(levelStarted);
 
         double bestLocalAcc = -1.0;
         int featureToRemoveThisLevel = -1;
 
         for (int feature_to_potentially_remove : currentFeatures) {
-            std::vector<int> trialFeatures = currentFeatures;
-            trialFeatures.erase(std::remove(trialFeatures.begin(), trialFeatures.end(), feature_to_potentially_remove), trialFeatures.end());
-
-            if (trialFeatures.empty()) continue;
-
-            std::vector<std::vector<double> > projectedX;
-            for (const auto& row : X) {
-                std::vector<double> proj;
-                for (int idx : trialFeatures) {
-                    proj.push_back(row[idx]);
-                }
-                projectedX.push_back(proj);
-            }
-            double acc = KNNUtils::nnLeaveOneOutCV(projectedX, y);
-            std::cout << "    Considering removing feature " << feature_to_potentially_remove + 1 << ". Remaining set {";
-            for(size_t i = 0; i < trialFeatures.size(); ++i) {
-                std::cout << trialFeatures[i] + 1 << (i == trialFeatures.size() - 1 ? "" : ", ");
-            }
-            std::cout << "} accuracy is " << acc * 100 << "%\n";
+            size_t d = currentFeatures.size() - 1;
+            if (d == 0) continue;
+
+            size_t heapBeforeCandidate = HeapCounter::allocationsOnThisThread();
+            Arena::Scope scratch(arena);
+            int* trialFeatures = arena.allocateArray<int>(d);
+            std::remove_copy(currentFeatures.begin(), currentFeatures.end(), trialFeatures, feature_to_potentially_remove);
+
+            double* projectedX = arena.allocateArray<double>(n * d);
+            projectRows(X, trialFeatures, d, projectedX);
+            double acc = KNNUtils::nnLeaveOneOutCV(projectedX, n, d, y);
+            SearchEvent candidate(SearchEvent::CandidateEvaluated, SearchEvent::Backward);
+            candidate.level = k + 1;
+            candidate.feature = feature_to_potentially_remove;
+            candidate.features = FeatureList(trialFeatures, d);
+            candidate.accuracy = acc;
+            sink.emit(candidate);
+            loopHeapAllocations += HeapCounter::allocationsOnThisThread() - heapBeforeCandidate;
 
             if (acc >= bestLocalAcc) {
                 bestLocalAcc = acc;
@@ -172,33 +416,176 @@ std::vector<std::pair<std::vector<int>, double>> FeatureSelector::backwardElimin
             currentFeatures.erase(std::remove(currentFeatures.begin(), currentFeatures.end(), featureToRemoveThisLevel), currentFeatures.end());
             std::sort(currentFeatures.begin(), currentFeatures.end());
 
-            std::cout << "\nOn level " << k + 1 << ", removed feature " << featureToRemoveThisLevel + 1 << ". Accuracy with remaining features: " << bestLocalAcc * 100 << "%\n";
-            std::cout << "Current best feature set: {";
-            for(size_t i = 0; i < currentFeatures.size(); ++i) {
-                std::cout << currentFeatures[i] + 1 << (i == currentFeatures.size() - 1 ? "" : ", ");
-            }
-            std::cout << "} with accuracy " << bestLocalAcc * 100 << "%\n";
-
             // Store the current result
             results.push_back({currentFeatures, bestLocalAcc});
 
+            SearchEvent levelCompleted(SearchEvent::LevelCompleted, SearchEvent::Backward);
+            levelCompleted.level = k + 1;
+            levelCompleted.feature = featureToRemoveThisLevel;
+            levelCompleted.features = FeatureList(currentFeatures);
+            levelCompleted.accuracy = bestLocalAcc;
+            levelCompleted.improved = bestLocalAcc >= globalBestAcc;
+            sink.emit(levelCompleted);
+
             if (bestLocalAcc >= globalBestAcc) {
                 globalBestAcc = bestLocalAcc;
                 bestFeaturesOverall = currentFeatures;
-            } else {
-                std::cout << "(Warning, accuracy has decreased. Global best is still better.)\n";
             }
         } else {
-            std::cout << "\nCould not determine a feature to remove or no feature removal improved/maintained accuracy. Halting backward elimination.\n";
+            SearchEvent halted(SearchEvent::SearchHalted, SearchEvent::Backward);
+            halted.level = k + 1;
+            halted.features = FeatureList(currentFeatures);
+            sink.emit(halted);
+            break;
+        }
+    }
+
+    SearchEvent finished(SearchEvent::SearchFinished, SearchEvent::Backward);
+    finished.features = FeatureList(bestFeaturesOverall);
+    finished.accuracy = globalBestAcc;
+    reportMemory(finished, scratchBefore, arena.stats(), heapBefore, loopHeapAllocations);
+    sink.emit(finished);
+
+    return results;
+}
+
+std::vector<std::pair<std::vector<int>, double>> FeatureSelector::exhaustiveSearch(
+    const std::vector<std::vector<double> >& X, const std::vector<int>& y, ResultSink& sink,
+    bool earlyAbandon) {
+    std::vector<std::pair<std::vector<int>, double>> results;
+
+    if (X.empty() || X[0].empty()) {
+        sink.emit(SearchEvent(SearchEvent::SearchAborted, SearchEvent::Exhaustive));
+        return results;
+    }
+
+    size_t n = X.size();
+    size_t numFeatures = X[0].size();
+    if (numFeatures > kMaxExhaustiveFeatures) {
+        std::ostringstream msg;
+        msg << "exhaustive search supports at most " << kMaxExhaustiveFeatures
+            << " features, but the data has " << numFeatures;
+        throw std::invalid_argument(msg.str());
+    }
+    // Every worker keeps a stack of n x n distance matrices, one per level of its walk.
+    size_t maxMatrices = n > kMaxExhaustiveScratchBytes / sizeof(double) / n
+        ? 0 : kMaxExhaustiveScratchBytes / (n * n * sizeof(double));
+    if (maxMatrices == 0) {
+        std::ostringstream msg;
+        msg << "exhaustive search needs " << n << " x " << n << " distances per thread, which exceeds "
+            << kMaxExhaustiveScratchBytes << " bytes; use fewer samples";
+        throw std::invalid_argument(msg.str());
+    }
+    size_t heapBefore = HeapCounter::allocationsOnThisThread();
+
+    // Column-major copy, so adding one feature to the distances reads it contiguously.
+    std::vector<double> columns(n * numFeatures);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t f = 0; f < numFeatures; ++f) {
+            columns[f * n + i] = X[i][f];
+        }
+    }
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    // A few subtrees per thread keeps the workers busy until the end. More
+    // (smaller) subtrees also mean shallower walks, so fix enough features
+    // for one walk's matrices to fit, then run as many walks as fit.
+    size_t prefixBits = 0;
+    while (prefixBits < numFeatures && (size_t(1) << prefixBits) < numThreads * 8) ++prefixBits;
+    prefixBits = std::max(prefixBits, numFeatures - std::min(numFeatures, maxMatrices - 1));
+    numThreads = std::max<size_t>(1, std::min(numThreads, maxMatrices / (numFeatures - prefixBits + 1)));
+
+    ExhaustiveSearch search;
+    search.columns = &columns[0];
+    search.n = n;
+    search.numFeatures = numFeatures;
+    search.prefixBits = prefixBits;
+    search.lowBits = numFeatures - prefixBits;
+    search.numSubtrees = size_t(1) << prefixBits;
+    search.y = &y;
+    search.earlyAbandon = earlyAbandon;
+    search.sink = &sink;
+    search.nextSubtree = 0;
+    search.abandoned = 0;
+    search.failed = false;
+    search.bestCorrect.reset(new std::atomic<int>[numFeatures + 1]);
+    for (size_t k = 0; k <= numFeatures; ++k) search.bestCorrect[k] = -1;
+
+    SearchEvent started(SearchEvent::SearchStarted, SearchEvent::Exhaustive);
+    std::vector<int> allFeatures(numFeatures);
+    std::iota(allFeatures.begin(), allFeatures.end(), 0);
+    started.features = FeatureList(allFeatures);
+    sink.emit(started);
+
+    numThreads = std::min(numThreads, search.numSubtrees);
+    std::vector<ExhaustiveWorkerResult> workerResults(numThreads);
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < numThreads; ++t) {
+        try {
+            workers.push_back(std::thread(runExhaustiveWorker, std::ref(search), std::ref(workerResults[t])));
+        } catch (const std::system_error&) {
+            // Workers claim subtrees as they go, so fewer threads still cover everything.
+            workerResults.resize(t);
             break;
         }
     }
+    runExhaustiveWorker(search, workerResults[0]);
+    for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t].join();
+    }
+    for (size_t t = 0; t < workerResults.size(); ++t) {
+        if (workerResults[t].error) std::rethrow_exception(workerResults[t].error);
+    }
 
-    std::cout << "\nFinished backward elimination!! The best feature subset is: {";
-    for (size_t i = 0; i < bestFeaturesOverall.size(); ++i) {
-        std::cout << bestFeaturesOverall[i] + 1 << (i == bestFeaturesOverall.size() - 1 ? "" : ", ");
+    double globalBestAcc = -1.0;
+    std::vector<int> bestFeaturesOverall;
+    for (size_t size = 1; size <= numFeatures; ++size) {
+        int correct = -1;
+        SubsetMask mask = 0;
+        for (size_t t = 0; t < workerResults.size(); ++t) {
+            const ExhaustiveWorkerResult& r = workerResults[t];
+            if (r.bestCorrect[size] > correct || (r.bestCorrect[size] == correct && r.bestMask[size] < mask)) {
+                correct = r.bestCorrect[size];
+                mask = r.bestMask[size];
+            }
+        }
+        if (correct < 0) continue;
+
+        std::vector<int> features;
+        for (size_t f = 0; f < numFeatures; ++f) {
+            if (mask & (SubsetMask(1) << f)) features.push_back(static_cast<int>(f));
+        }
+        double acc = static_cast<double>(correct) / n;
+        results.push_back({features, acc});
+
+        SearchEvent levelCompleted(SearchEvent::LevelCompleted, SearchEvent::Exhaustive);
+        levelCompleted.level = size;
+        levelCompleted.features = FeatureList(features);
+        levelCompleted.accuracy = acc;
+        levelCompleted.improved = acc > globalBestAcc;
+        sink.emit(levelCompleted);
+
+        if (acc > globalBestAcc) {
+            globalBestAcc = acc;
+            bestFeaturesOverall = features;
+        }
     }
-    std::cout << "}, which has an accuracy of " << globalBestAcc * 100 << "%\n";
+
+    SearchEvent finished(SearchEvent::SearchFinished, SearchEvent::Exhaustive);
+    finished.features = FeatureList(bestFeaturesOverall);
+    finished.accuracy = globalBestAcc;
+    // The first worker ran on this thread, so its allocations are already in
+    // this thread's count; the others are added on top.
+    finished.heapAllocations = HeapCounter::allocationsOnThisThread() - heapBefore;
+    for (size_t t = 0; t < workerResults.size(); ++t) {
+        const ExhaustiveWorkerResult& r = workerResults[t];
+        finished.scratchAllocations += r.scratch.allocations;
+        finished.scratchPeakBytes += r.scratch.peakBytes; // summed over threads
+        if (t > 0) finished.heapAllocations += r.heapAllocations;
+        finished.loopHeapAllocations += r.loopHeapAllocations;
+    }
+    finished.abandonedCandidates = search.abandoned;
+    sink.emit(finished);
 
     return results;
-}
\ No newline at end of file
+}
@@ -5,17 +5,52 @@
 #include <string> // Though not directly used by methods, often included with vector
 #include <utility>
 #include "knn_utils.h" // Needs KNNUtils for its operations
+#include "result_sink.h"
 
 class FeatureSelector {
 public:
+    // Largest feature count exhaustiveSearch accepts; the work grows as 2^F.
+    static const size_t kMaxExhaustiveFeatures = 24;
+    // Most memory exhaustiveSearch may use for its distance matrices; each
+    // thread keeps a few of n x n doubles for n samples.
+    static const size_t kMaxExhaustiveScratchBytes = size_t(1) << 30;
+
     static std::vector<std::pair<std::vector<int>, double>> forwardSelection(
         const std::vector<std::vector<double> >& X, 
-        const std::vector<int>& y
+        const std::vector<int>& y,
+        ResultSink& sink
     );
     
     static std::vector<std::pair<std::vector<int>, double>> backwardElimination(
         const std::vector<std::vector<double> >& X, 
-        const std::vector<int>& y
+        const std::vector<int>& y,
+        ResultSink& sink
+    );
+
+    // Evaluates every non-empty feature subset and returns the best subset of
+    // each size, so the overall best is the true global optimum. Each subset's
+    // distance matrix is built from its parent's by adding one feature above
+    // all of the parent's, so no matrix is rebuilt from scratch and every
+    // accuracy is exactly what nnLeaveOneOutCV gives for that subset (see
+    // check_exhaustive.cpp). Runs on all hardware threads; sink receives
+    // events from several threads, but never concurrently. Fewer threads are
+    // used if their matrices would not fit in kMaxExhaustiveScratchBytes.
+    // With earlyAbandon, scoring a subset stops as soon as it has made more
+    // mistakes than the best subset of the same size seen so far; its
+    // CandidateEvaluated event is then marked abandoned and has no accuracy.
+    // The best subsets are the same. No subset is skipped (1-NN accuracy does
+    // not shrink or grow predictably as features are added, so there is no
+    // bound to prune with), so this only trims the scoring pass and does not
+    // raise kMaxExhaustiveFeatures.
+    // Throws std::invalid_argument above kMaxExhaustiveFeatures features or if
+    // a single distance matrix does not fit in kMaxExhaustiveScratchBytes.
+    // An exception thrown in a worker (e.g. by the sink) stops the search and
+    // is rethrown once all workers have finished.
+    static std::vector<std::pair<std::vector<int>, double>> exhaustiveSearch(
+        const std::vector<std::vector<double> >& X,
+        const std::vector<int>& y,
+        ResultSink& sink,
+        bool earlyAbandon = false
     );
 };
 
@@ -0,0 +1,14 @@
+#ifndef HEAP_COUNTER_H
+#define HEAP_COUNTER_H
+
+#include <cstddef>
+
+// Counts real heap allocations (every call of the global operator new) made
+// by the calling thread, so the search can report how many allocations its
+// loops make. Linking heap_counter.cpp replaces the global operator new/delete.
+class HeapCounter {
+public:
+    static size_t allocationsOnThisThread();
+};
+
+#endif // HEAP_COUNTER_H
@@ -1,66 +1,27 @@
 #include "knn_utils.h"
-#include <fstream>
-#include <sstream>
+#include "data_loader.h"
 #include <numeric> // For std::accumulate, std::iota, std::inner_product
 #include <cmath>   // For std::sqrt
 #include <limits>  // For std::numeric_limits
 
 std::pair<std::vector<std::vector<double> >, std::vector<int> > KNNUtils::loadData(const std::string& filename) {
-    std::ifstream file(filename);
-    std::string line;
-    std::vector<std::vector<double> > X;
-    std::vector<int> y;
-
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::vector<double> row;
-        double value;
-        bool isFirst = true;
-        int label = 0; // Initialize label
-        while (ss >> value) {
-            if (isFirst) {
-                label = static_cast<int>(value);
-                isFirst = false;
-            } else {
-                row.push_back(value);
-            }
-        }
-        X.push_back(row);
-        y.push_back(label);
-    }
-    return std::make_pair(X, y);
+    // Whitespace-separated, no header, label in the first column
+    LoadOptions options;
+    options.delimiter = ' ';
+    options.header = 0;
+    options.labelColumn = 0;
+    LoadedData data = DataLoader::load(filename, options);
+    return std::make_pair(data.X, data.y);
 }
 
 std::pair<std::vector<std::vector<double> >, std::vector<int> > KNNUtils::loadCSVData(const std::string& filename) {
-    std::ifstream file(filename);
-    std::string line;
-    std::vector<std::vector<double> > X;
-    std::vector<int> y;
-
-    // Skip header line
-    std::getline(file, line);
-
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string value;
-        std::vector<double> row;
-        int feature_count = 0;
-
-        while (std::getline(ss, value, ',')) {
-            double num_value = std::stod(value);
-            if (feature_count < 8) { // First 8 columns are features
-                row.push_back(num_value);
-            } else { // Last column is the label
-                y.push_back(static_cast<int>(num_value));
-            }
-            feature_count++;
-        }
-        
-        if (!row.empty()) {
-            X.push_back(row);
-        }
-    }
-    return std::make_pair(X, y);
+    // Comma-separated with a header line, label in the last column
+    LoadOptions options;
+    options.delimiter = ',';
+    options.header = 1;
+    options.labelColumn = -1;
+    LoadedData data = DataLoader::load(filename, options);
+    return std::make_pair(data.X, data.y);
 }
 
 std::vector<double> KNNUtils::zNormalize(const std::vector<double>& data) {
@@ -115,4 +76,30 @@ double KNNUtils::nnLeaveOneOutCV(const std::vector<std::vector<double> >& X, con
         if (predicted == y[i]) correct++;
     }
     return static_cast<double>(correct) / X.size();
-}
\ No newline at end of file
+}
+
+double KNNUtils::nnLeaveOneOutCV(const double* X, size_t n, size_t d, const std::vector<int>& y) {
+    if (n == 0 || d == 0 || n != y.size()) {
+        return 0.0;
+    }
+    int correct = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const double* a = X + i * d;
+        double minDist = std::numeric_limits<double>::max();
+        int predicted = -1;
+        for (size_t j = 0; j < n; ++j) {
+            if (i == j) continue;
+            const double* b = X + j * d;
+            double dist = 0;
+            for (size_t k = 0; k < d; ++k) {
+                dist += (a[k] - b[k]) * (a[k] - b[k]);
+            }
+            if (dist < minDist) {
+                minDist = dist;
+                predicted = y[j];
+            }
+        }
+        if (predicted == y[i]) correct++;
+    }
+    return static_cast<double>(correct) / n;
+}
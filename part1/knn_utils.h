@@ -12,6 +12,9 @@ public:
     static std::vector<double> zNormalize(const std::vector<double>& data);
     static double euclideanDistance(const std::vector<double>& a, const std::vector<double>& b);
     static double nnLeaveOneOutCV(const std::vector<std::vector<double> >& X, const std::vector<int>& y);
+    // Same as above for n samples of d features stored row-major in X.
+    // Compares squared distances, so no buffers are allocated and no sqrt is taken.
+    static double nnLeaveOneOutCV(const double* X, size_t n, size_t d, const std::vector<int>& y);
 };
 
 #endif // KNN_UTILS_H
\ No newline at end of file
@@ -5,9 +5,12 @@
 #include <iomanip>
 #include <algorithm>
 #include <utility>
+#include <memory>
 #include "knn_utils.h"
+#include "data_loader.h"
 #include "feature_selector.h"
 #include "plot_utils.h"
+#include "result_sink.h"
 
 struct FeatureResult {
     std::vector<int> features;
@@ -15,19 +18,90 @@ struct FeatureResult {
 };
 
 void printDatasetMenu() {
-    std::cout << "\nAvailable datasets:" << std::endl;
-    std::cout << "1. CS205 Large Dataset (CS205_large_Data__17.txt)" << std::endl;
-    std::cout << "2. CS205 Small Dataset (CS205_small_Data__10.txt)" << std::endl;
-    std::cout << "3. Diabetes Dataset (diabetes.csv)" << std::endl;
-    std::cout << "Please enter your choice (1-3): ";
+    std::cerr << "\nAvailable datasets:" << std::endl;
+    std::cerr << "1. CS205 Large Dataset (CS205_large_Data__17.txt)" << std::endl;
+    std::cerr << "2. CS205 Small Dataset (CS205_small_Data__10.txt)" << std::endl;
+    std::cerr << "3. Diabetes Dataset (diabetes.csv)" << std::endl;
+    std::cerr << "4. Other File (CSV/TSV/whitespace, format detected)" << std::endl;
+    std::cerr << "Please enter your choice (1-4): ";
 }
 
 void printAlgorithmMenu() {
-    std::cout << "\nAvailable algorithms:" << std::endl;
-    std::cout << "1. Forward Selection" << std::endl;
-    std::cout << "2. Backward Elimination" << std::endl;
-    std::cout << "3. Both Algorithms" << std::endl;
-    std::cout << "Please enter your choice (1-3): ";
+    std::cerr << "\nAvailable algorithms:" << std::endl;
+    std::cerr << "1. Forward Selection" << std::endl;
+    std::cerr << "2. Backward Elimination" << std::endl;
+    std::cerr << "3. Both Algorithms" << std::endl;
+    std::cerr << "4. Exhaustive Search (all subsets, up to " << FeatureSelector::kMaxExhaustiveFeatures << " features)" << std::endl;
+    std::cerr << "Please enter your choice (1-4): ";
+}
+
+void printOutputMenu() {
+    std::cerr << "\nAvailable output formats:" << std::endl;
+    std::cerr << "1. Detailed (every candidate)" << std::endl;
+    std::cerr << "2. Quiet (level decisions only)" << std::endl;
+    std::cerr << "3. NDJSON" << std::endl;
+    std::cerr << "4. CSV" << std::endl;
+    std::cerr << "Please enter your choice (1-4): ";
+}
+
+enum SearchAlgorithm {
+    FORWARD_SELECTION,
+    BACKWARD_ELIMINATION,
+    EXHAUSTIVE_SEARCH
+};
+
+// Search results go to stdout through `output`; menus and status lines go to
+// stderr, so NDJSON and CSV output stays machine-readable.
+std::unique_ptr<ResultSink> makeOutputSink(int outputChoice) {
+    std::unique_ptr<ResultSink> output;
+    switch (outputChoice) {
+        case 2: output.reset(new TextResultSink(std::cout, true)); break;
+        case 3: output.reset(new NdjsonResultSink(std::cout)); break;
+        case 4: output.reset(new CsvResultSink(std::cout)); break;
+        default: output.reset(new TextResultSink(std::cout)); break;
+    }
+    return output;
+}
+
+void runSearch(SearchAlgorithm algorithm, const std::vector<std::vector<double> >& X, const std::vector<int>& y,
+               const std::string& datasetFile, ResultSink& output) {
+    std::string plotFile;
+    std::string plotTitle;
+    switch (algorithm) {
+        case FORWARD_SELECTION:
+            plotFile = "forward_selection_results.png";
+            plotTitle = "Forward Selection Results - " + datasetFile;
+            break;
+        case BACKWARD_ELIMINATION:
+            plotFile = "backward_elimination_results.png";
+            plotTitle = "Backward Elimination Results - " + datasetFile;
+            break;
+        default:
+            plotFile = "exhaustive_search_results.png";
+            plotTitle = "Exhaustive Search Results - " + datasetFile;
+            break;
+    }
+    PlotResultSink plot(plotFile, plotTitle);
+
+    std::vector<ResultSink*> sinks;
+    sinks.push_back(&output);
+    sinks.push_back(&plot);
+    TeeResultSink tee(sinks);
+    AsyncResultSink sink(tee);
+
+    switch (algorithm) {
+        case FORWARD_SELECTION:
+            FeatureSelector::forwardSelection(X, y, sink);
+            break;
+        case BACKWARD_ELIMINATION:
+            FeatureSelector::backwardElimination(X, y, sink);
+            break;
+        case EXHAUSTIVE_SEARCH:
+            // Same best subsets either way; hopeless subsets are reported as abandoned.
+            FeatureSelector::exhaustiveSearch(X, y, sink, true);
+            break;
+    }
+    sink.flush();
 }
 
 void clearInputBuffer() {
@@ -40,11 +114,13 @@ int main() {
     int datasetChoice;
     std::string datasetFile;
     bool isCSV = false;
+    bool isOther = false;
+    LoadOptions otherOptions;
 
     while (true) {
         printDatasetMenu();
         if (!(std::cin >> datasetChoice)) {
-            std::cout << "Invalid input. Please enter a number." << std::endl;
+            std::cerr << "Invalid input. Please enter a number." << std::endl;
             clearInputBuffer();
             continue;
         }
@@ -60,19 +136,47 @@ int main() {
                 datasetFile = "diabetes.csv";
                 isCSV = true;
                 break;
+            case 4: {
+                std::cerr << "Enter the file path: ";
+                std::cin >> datasetFile;
+                int labelColumn;
+                std::cerr << "Enter the label column (1-based, 0 for the last column): ";
+                while (!(std::cin >> labelColumn) || labelColumn < 0) {
+                    std::cerr << "Invalid input. Please enter a non-negative number: ";
+                    clearInputBuffer();
+                }
+                otherOptions.labelColumn = labelColumn == 0 ? -1 : labelColumn - 1;
+                isOther = true;
+                break;
+            }
             default:
-                std::cout << "Invalid choice. Please enter a number between 1 and 3." << std::endl;
+                std::cerr << "Invalid choice. Please enter a number between 1 and 4." << std::endl;
                 continue;
         }
         break;
     }
 
     // Load the selected dataset
-    std::cout << "\nAttempting to load data from '" << datasetFile << "'..." << std::endl;
+    std::cerr << "\nAttempting to load data from '" << datasetFile << "'..." << std::endl;
     std::pair<std::vector<std::vector<double>>, std::vector<int>> data;
     
     try {
-        if (isCSV) {
+        if (isOther) {
+            LoadedData loaded = DataLoader::load(datasetFile, otherOptions);
+            std::cerr << "Detected " << (loaded.delimiter == ' ' ? std::string("whitespace")
+                                         : loaded.delimiter == '\t' ? std::string("tab")
+                                         : "'" + std::string(1, loaded.delimiter) + "'")
+                      << "-separated columns, " << (loaded.hasHeader ? "with" : "without") << " a header; "
+                      << "label column '" << loaded.labelName << "', " << loaded.categoricalColumns
+                      << " categorical column(s) one-hot encoded into "
+                      << std::count(loaded.featureTypes.begin(), loaded.featureTypes.end(), LoadedData::CATEGORICAL)
+                      << " feature(s)." << std::endl;
+            if (loaded.imputedValues > 0 || loaded.droppedRows > 0) {
+                std::cerr << "Filled in " << loaded.imputedValues << " missing value(s), dropped "
+                          << loaded.droppedRows << " row(s) without a label." << std::endl;
+            }
+            data = std::make_pair(loaded.X, loaded.y);
+        } else if (isCSV) {
             data = KNNUtils::loadCSVData(datasetFile);
         } else {
             data = KNNUtils::loadData(datasetFile);
@@ -104,7 +208,7 @@ int main() {
         }
     }
 
-    std::cout << "Data loaded successfully: " << X.size() << " samples, "
+    std::cerr << "Data loaded successfully: " << X.size() << " samples, "
               << (X.empty() ? 0 : X[0].size()) << " features." << std::endl;
 
     // Get algorithm choice
@@ -112,47 +216,62 @@ int main() {
     while (true) {
         printAlgorithmMenu();
         if (!(std::cin >> algorithmChoice)) {
-            std::cout << "Invalid input. Please enter a number." << std::endl;
+            std::cerr << "Invalid input. Please enter a number." << std::endl;
             clearInputBuffer();
             continue;
         }
         
-        if (algorithmChoice >= 1 && algorithmChoice <= 3) {
+        if (algorithmChoice >= 1 && algorithmChoice <= 4) {
+            break;
+        }
+        std::cerr << "Invalid choice. Please enter a number between 1 and 4." << std::endl;
+    }
+
+    // Get output format choice
+    int outputChoice;
+    while (true) {
+        printOutputMenu();
+        if (!(std::cin >> outputChoice)) {
+            std::cerr << "Invalid input. Please enter a number." << std::endl;
+            clearInputBuffer();
+            continue;
+        }
+
+        if (outputChoice >= 1 && outputChoice <= 4) {
             break;
         }
-        std::cout << "Invalid choice. Please enter a number between 1 and 3." << std::endl;
+        std::cerr << "Invalid choice. Please enter a number between 1 and 4." << std::endl;
     }
 
-    // Run selected algorithm(s)
+    // Run selected algorithm(s). Both searches share one output sink, so a
+    // CSV stream gets a single header.
+    std::unique_ptr<ResultSink> output = makeOutputSink(outputChoice);
     try {
         switch (algorithmChoice) {
             case 1: {
-                std::cout << "\nRunning Forward Selection..." << std::endl;
-                auto forwardResults = FeatureSelector::forwardSelection(X, y);
-                std::string plotTitle = "Forward Selection Results - " + datasetFile;
-                PlotUtils::plotResults(forwardResults, "forward_selection_results.png", plotTitle);
+                std::cerr << "\nRunning Forward Selection..." << std::endl;
+                runSearch(FORWARD_SELECTION, X, y, datasetFile, *output);
                 break;
             }
             case 2: {
-                std::cout << "\nRunning Backward Elimination..." << std::endl;
-                auto backwardResults = FeatureSelector::backwardElimination(X, y);
-                std::string plotTitle = "Backward Elimination Results - " + datasetFile;
-                PlotUtils::plotResults(backwardResults, "backward_elimination_results.png", plotTitle);
+                std::cerr << "\nRunning Backward Elimination..." << std::endl;
+                runSearch(BACKWARD_ELIMINATION, X, y, datasetFile, *output);
                 break;
             }
             case 3: {
-                std::cout << "\nRunning Forward Selection..." << std::endl;
-                auto forwardResults = FeatureSelector::forwardSelection(X, y);
-                std::string forwardTitle = "Forward Selection Results - " + datasetFile;
-                PlotUtils::plotResults(forwardResults, "forward_selection_results.png", forwardTitle);
+                std::cerr << "\nRunning Forward Selection..." << std::endl;
+                runSearch(FORWARD_SELECTION, X, y, datasetFile, *output);
                 
-                std::cout << "\n----------------------------------------" << std::endl;
-                std::cout << "----------------------------------------\n" << std::endl;
+                std::cerr << "\n----------------------------------------" << std::endl;
+                std::cerr << "----------------------------------------\n" << std::endl;
                 
-                std::cout << "Running Backward Elimination..." << std::endl;
-                auto backwardResults = FeatureSelector::backwardElimination(X, y);
-                std::string backwardTitle = "Backward Elimination Results - " + datasetFile;
-                PlotUtils::plotResults(backwardResults, "backward_elimination_results.png", backwardTitle);
+                std::cerr << "Running Backward Elimination..." << std::endl;
+                runSearch(BACKWARD_ELIMINATION, X, y, datasetFile, *output);
+                break;
+            }
+            case 4: {
+                std::cerr << "\nRunning Exhaustive Search..." << std::endl;
+                runSearch(EXHAUSTIVE_SEARCH, X, y, datasetFile, *output);
                 break;
             }
         }
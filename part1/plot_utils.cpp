@@ -1,61 +1,631 @@
 #include "plot_utils.h"
 #include <fstream>
 #include <sstream>
-#include <cstdlib>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
-void PlotUtils::writeDataFile(const std::vector<std::pair<std::vector<int>, double>>& results,
-                            const std::string& dataFile) {
-    std::ofstream file(dataFile);
-    for (size_t i = 0; i < results.size(); ++i) {
-        // Write feature set size and accuracy
-        file << i + 1 << " " 
-             << results[i].second * 100 << " \"";
-        
-        // Write feature set as label
-        const auto& features = results[i].first;
-        for (size_t j = 0; j < features.size(); ++j) {
-            file << features[j] + 1;
-            if (j < features.size() - 1) file << ",";
+namespace {
+
+long currentProcessId() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return static_cast<long>(getpid());
+#endif
+}
+
+// Chart geometry, shared by the PNG and SVG backends so both look the same.
+const int kWidth = 1200;
+const int kHeight = 800;
+const int kLeft = 110;
+const int kRight = 40;
+const int kTop = 90;
+const int kBottom = 150;
+const int kPlotWidth = kWidth - kLeft - kRight;
+const int kPlotHeight = kHeight - kTop - kBottom;
+
+struct Color {
+    unsigned char r, g, b;
+};
+
+const Color kWhite = {255, 255, 255};
+const Color kBlack = {0, 0, 0};
+const Color kGrid = {220, 220, 220};
+const Color kBar = {0x41, 0x69, 0xE1};
+
+struct Bar {
+    int x0, x1, top;
+    std::string value;    // accuracy label drawn above the bar
+    std::string size;     // number of features, used as the x tick
+    std::string features; // feature set drawn under the tick
+};
+
+std::string featureSetLabel(const std::vector<int>& features) {
+    std::ostringstream os;
+    os << "{";
+    for (size_t j = 0; j < features.size(); ++j) {
+        os << features[j] + 1;
+        if (j < features.size() - 1) os << ",";
+    }
+    os << "}";
+    return os.str();
+}
+
+std::vector<Bar> layoutBars(const std::vector<PlotLevel>& levels) {
+    std::vector<Bar> bars;
+    if (levels.empty()) return bars;
+    double slot = static_cast<double>(kPlotWidth) / levels.size();
+    for (size_t i = 0; i < levels.size(); ++i) {
+        double accuracy = std::max(0.0, std::min(1.0, levels[i].accuracy));
+        Bar bar;
+        // Same proportions as gnuplot's "boxwidth 0.8".
+        bar.x0 = kLeft + static_cast<int>(slot * i + slot * 0.1);
+        bar.x1 = kLeft + static_cast<int>(slot * (i + 1) - slot * 0.1);
+        bar.top = kTop + kPlotHeight - static_cast<int>(accuracy * kPlotHeight + 0.5);
+        char value[16];
+        std::snprintf(value, sizeof(value), "%.1f", levels[i].accuracy * 100);
+        bar.value = value;
+        std::ostringstream size;
+        size << levels[i].features.size();
+        bar.size = size.str();
+        bar.features = featureSetLabel(levels[i].features);
+        bars.push_back(bar);
+    }
+    return bars;
+}
+
+// Writes via a temporary file and renames it into place, so a reader polling
+// the chart during a live search never sees a partially written file. The
+// temporary name is unique per process and call, so concurrent runs writing
+// the same chart never clobber each other's half-written file.
+bool replaceFile(const std::string& path, const char* data, size_t size) {
+    static std::atomic<unsigned long> counter(0);
+    std::ostringstream tmpName;
+    tmpName << path << "." << currentProcessId() << "." << counter++ << ".tmp";
+    std::string tmp = tmpName.str();
+    {
+        std::ofstream file(tmp.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(data, size);
+        if (!file) {
+            file.close();
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+#ifdef _WIN32
+    // rename() does not replace an existing file here, so this platform has a
+    // short window in which the chart is missing.
+    std::remove(path.c_str());
+#endif
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ---- Raster backend -------------------------------------------------------
+
+// 5x7 bitmap font. Lower case letters are drawn with the upper case glyphs.
+struct Glyph {
+    char c;
+    const char* rows[7];
+};
+
+const Glyph kFont[] = {
+    {' ', {".....", ".....", ".....", ".....", ".....", ".....", "....."}},
+    {'A', {".###.", "#...#", "#...#", "#####", "#...#", "#...#", "#...#"}},
+    {'B', {"####.", "#...#", "#...#", "####.", "#...#", "#...#", "####."}},
+    {'C', {".###.", "#...#", "#....", "#....", "#....", "#...#", ".###."}},
+    {'D', {"####.", "#...#", "#...#", "#...#", "#...#", "#...#", "####."}},
+    {'E', {"#####", "#....", "#....", "####.", "#....", "#....", "#####"}},
+    {'F', {"#####", "#....", "#....", "####.", "#....", "#....", "#...."}},
+    {'G', {".###.", "#...#", "#....", "#.###", "#...#", "#...#", ".####"}},
+    {'H', {"#...#", "#...#", "#...#", "#####", "#...#", "#...#", "#...#"}},
+    {'I', {".###.", "..#..", "..#..", "..#..", "..#..", "..#..", ".###."}},
+    {'J', {"..###", "...#.", "...#.", "...#.", "...#.", "#..#.", ".##.."}},
+    {'K', {"#...#", "#..#.", "#.#..", "##...", "#.#..", "#..#.", "#...#"}},
+    {'L', {"#....", "#....", "#....", "#....", "#....", "#....", "#####"}},
+    {'M', {"#...#", "##.##", "#.#.#", "#.#.#", "#...#", "#...#", "#...#"}},
+    {'N', {"#...#", "#...#", "##..#", "#.#.#", "#..##", "#...#", "#...#"}},
+    {'O', {".###.", "#...#", "#...#", "#...#", "#...#", "#...#", ".###."}},
+    {'P', {"####.", "#...#", "#...#", "####.", "#....", "#....", "#...."}},
+    {'Q', {".###.", "#...#", "#...#", "#...#", "#.#.#", "#..#.", ".##.#"}},
+    {'R', {"####.", "#...#", "#...#", "####.", "#.#..", "#..#.", "#...#"}},
+    {'S', {".####", "#....", "#....", ".###.", "....#", "....#", "####."}},
+    {'T', {"#####", "..#..", "..#..", "..#..", "..#..", "..#..", "..#.."}},
+    {'U', {"#...#", "#...#", "#...#", "#...#", "#...#", "#...#", ".###."}},
+    {'V', {"#...#", "#...#", "#...#", "#...#", "#...#", ".#.#.", "..#.."}},
+    {'W', {"#...#", "#...#", "#...#", "#.#.#", "#.#.#", "#.#.#", ".#.#."}},
+    {'X', {"#...#", "#...#", ".#.#.", "..#..", ".#.#.", "#...#", "#...#"}},
+    {'Y', {"#...#", "#...#", ".#.#.", "..#..", "..#..", "..#..", "..#.."}},
+    {'Z', {"#####", "....#", "...#.", "..#..", ".#...", "#....", "#####"}},
+    {'0', {".###.", "#...#", "#..##", "#.#.#", "##..#", "#...#", ".###."}},
+    {'1', {"..#..", ".##..", "..#..", "..#..", "..#..", "..#..", ".###."}},
+    {'2', {".###.", "#...#", "....#", "...#.", "..#..", ".#...", "#####"}},
+    {'3', {"#####", "...#.", "..#..", "...#.", "....#", "#...#", ".###."}},
+    {'4', {"...#.", "..##.", ".#.#.", "#..#.", "#####", "...#.", "...#."}},
+    {'5', {"#####", "#....", "####.", "....#", "....#", "#...#", ".###."}},
+    {'6', {"..##.", ".#...", "#....", "####.", "#...#", "#...#", ".###."}},
+    {'7', {"#####", "....#", "...#.", "..#..", ".#...", ".#...", ".#..."}},
+    {'8', {".###.", "#...#", "#...#", ".###.", "#...#", "#...#", ".###."}},
+    {'9', {".###.", "#...#", "#...#", ".####", "....#", "...#.", ".##.."}},
+    {'.', {".....", ".....", ".....", ".....", ".....", ".##..", ".##.."}},
+    {',', {".....", ".....", ".....", ".....", ".##..", "..#..", ".#..."}},
+    {'-', {".....", ".....", ".....", "#####", ".....", ".....", "....."}},
+    {'_', {".....", ".....", ".....", ".....", ".....", ".....", "#####"}},
+    {'%', {"##...", "##..#", "...#.", "..#..", ".#...", "#..##", "...##"}},
+    {'(', {"...#.", "..#..", ".#...", ".#...", ".#...", "..#..", "...#."}},
+    {')', {".#...", "..#..", "...#.", "...#.", "...#.", "..#..", ".#..."}},
+    {'{', {"..##.", ".#...", ".#...", "#....", ".#...", ".#...", "..##."}},
+    {'}', {".##..", "...#.", "...#.", "....#", "...#.", "...#.", ".##.."}},
+    {'[', {".###.", ".#...", ".#...", ".#...", ".#...", ".#...", ".###."}},
+    {']', {".###.", "...#.", "...#.", "...#.", "...#.", "...#.", ".###."}},
+    {':', {".....", ".##..", ".##..", ".....", ".##..", ".##..", "....."}},
+    {'/', {".....", "....#", "...#.", "..#..", ".#...", "#....", "....."}},
+    {'+', {".....", "..#..", "..#..", "#####", "..#..", "..#..", "....."}},
+    {'=', {".....", ".....", "#####", ".....", "#####", ".....", "....."}},
+    {'!', {"..#..", "..#..", "..#..", "..#..", "..#..", ".....", "..#.."}},
+    {'\'', {"..#..", "..#..", ".#...", ".....", ".....", ".....", "....."}},
+    {'?', {".###.", "#...#", "....#", "...#.", "..#..", ".....", "..#.."}},
+};
+
+const Glyph& glyphFor(char c) {
+    if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    for (size_t i = 0; i < sizeof(kFont) / sizeof(kFont[0]); ++i) {
+        if (kFont[i].c == c) return kFont[i];
+    }
+    return kFont[sizeof(kFont) / sizeof(kFont[0]) - 1]; // '?'
+}
+
+int textWidth(const std::string& text, int scale) {
+    return text.empty() ? 0 : static_cast<int>(text.size()) * 6 * scale - scale;
+}
+
+class Canvas {
+public:
+    Canvas(int width, int height, Color background)
+        : width(width), height(height), pixels(width * height * 3) {
+        fillRect(0, 0, width, height, background);
+    }
+
+    void fillRect(int x0, int y0, int x1, int y1, Color c) {
+        x0 = std::max(x0, 0); y0 = std::max(y0, 0);
+        x1 = std::min(x1, width); y1 = std::min(y1, height);
+        for (int y = y0; y < y1; ++y) {
+            unsigned char* p = &pixels[(y * width + x0) * 3];
+            for (int x = x0; x < x1; ++x) {
+                *p++ = c.r; *p++ = c.g; *p++ = c.b;
+            }
+        }
+    }
+
+    // Draws text with its top-left corner at (x, y).
+    void drawText(int x, int y, const std::string& text, int scale, Color c) {
+        for (size_t i = 0; i < text.size(); ++i) {
+            const Glyph& g = glyphFor(text[i]);
+            for (int gy = 0; gy < 7; ++gy) {
+                for (int gx = 0; gx < 5; ++gx) {
+                    if (g.rows[gy][gx] != '#') continue;
+                    int px = x + (static_cast<int>(i) * 6 + gx) * scale;
+                    fillRect(px, y + gy * scale, px + scale, y + (gy + 1) * scale, c);
+                }
+            }
+        }
+    }
+
+    // Draws text rotated a quarter turn counter-clockwise, reading bottom to
+    // top, with the bottom-left corner of the first glyph at (x, y).
+    void drawTextVertical(int x, int y, const std::string& text, int scale, Color c) {
+        for (size_t i = 0; i < text.size(); ++i) {
+            const Glyph& g = glyphFor(text[i]);
+            for (int gy = 0; gy < 7; ++gy) {
+                for (int gx = 0; gx < 5; ++gx) {
+                    if (g.rows[gy][gx] != '#') continue;
+                    int px = x + gy * scale;
+                    int py = y - (static_cast<int>(i) * 6 + gx + 1) * scale;
+                    fillRect(px, py, px + scale, py + scale, c);
+                }
+            }
+        }
+    }
+
+    void drawTextCentered(int cx, int y, const std::string& text, int scale, Color c) {
+        drawText(cx - textWidth(text, scale) / 2, y, text, scale, c);
+    }
+
+    const unsigned char* row(int y) const { return &pixels[y * width * 3]; }
+
+    const int width;
+    const int height;
+
+private:
+    std::vector<unsigned char> pixels;
+};
+
+// ---- PNG encoding ---------------------------------------------------------
+
+void putU32(std::vector<unsigned char>& out, unsigned long v) {
+    out.push_back(static_cast<unsigned char>((v >> 24) & 0xFF));
+    out.push_back(static_cast<unsigned char>((v >> 16) & 0xFF));
+    out.push_back(static_cast<unsigned char>((v >> 8) & 0xFF));
+    out.push_back(static_cast<unsigned char>(v & 0xFF));
+}
+
+unsigned long crc32(const unsigned char* data, size_t size) {
+    static unsigned long table[256];
+    static bool initialized = false;
+    if (!initialized) {
+        for (unsigned long n = 0; n < 256; ++n) {
+            unsigned long c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320UL ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        initialized = true;
+    }
+    unsigned long crc = 0xFFFFFFFFUL;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFUL;
+}
+
+unsigned long adler32(const std::vector<unsigned char>& data) {
+    unsigned long a = 1, b = 0;
+    for (size_t i = 0; i < data.size(); ++i) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<unsigned char>& out) : out(out), bits(0), count(0) {}
+
+    // Plain values are packed least significant bit first.
+    void writeBits(unsigned long value, int n) {
+        bits |= value << count;
+        count += n;
+        while (count >= 8) {
+            out.push_back(static_cast<unsigned char>(bits & 0xFF));
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    // Huffman codes are packed most significant bit first.
+    void writeCode(unsigned long code, int n) {
+        for (int i = n - 1; i >= 0; --i) writeBits((code >> i) & 1, 1);
+    }
+
+    void finish() {
+        if (count > 0) out.push_back(static_cast<unsigned char>(bits & 0xFF));
+        bits = 0;
+        count = 0;
+    }
+
+private:
+    std::vector<unsigned char>& out;
+    unsigned long bits;
+    int count;
+};
+
+// Fixed Huffman literal/length alphabet (RFC 1951, 3.2.6).
+void writeSymbol(BitWriter& bw, int symbol) {
+    if (symbol < 144) bw.writeCode(0x30 + symbol, 8);
+    else if (symbol < 256) bw.writeCode(0x190 + (symbol - 144), 9);
+    else if (symbol < 280) bw.writeCode(symbol - 256, 7);
+    else bw.writeCode(0xC0 + (symbol - 280), 8);
+}
+
+void writeLength(BitWriter& bw, int length) {
+    static const int base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const int extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    int i = 28;
+    while (base[i] > length) --i;
+    writeSymbol(bw, 257 + i);
+    bw.writeBits(length - base[i], extra[i]);
+}
+
+// zlib stream using a single fixed-Huffman block. The only matches emitted are
+// runs of the previous byte (distance 1), which is all a chart needs once the
+// scanlines have been "Up"-filtered into long stretches of zeros.
+std::vector<unsigned char> zlibCompress(const std::vector<unsigned char>& data) {
+    std::vector<unsigned char> out;
+    out.push_back(0x78);
+    out.push_back(0x01);
+    BitWriter bw(out);
+    bw.writeBits(1, 1); // BFINAL
+    bw.writeBits(1, 2); // BTYPE = fixed Huffman
+    size_t i = 0;
+    while (i < data.size()) {
+        if (i > 0) {
+            size_t run = 0;
+            while (run < 258 && i + run < data.size() && data[i + run] == data[i - 1]) ++run;
+            if (run >= 3) {
+                writeLength(bw, static_cast<int>(run));
+                bw.writeCode(0, 5); // distance code 0 = distance 1
+                i += run;
+                continue;
+            }
+        }
+        writeSymbol(bw, data[i]);
+        ++i;
+    }
+    writeSymbol(bw, 256); // end of block
+    bw.finish();
+    putU32(out, adler32(data));
+    return out;
+}
+
+void putChunk(std::vector<unsigned char>& png, const char* type, const std::vector<unsigned char>& data) {
+    putU32(png, data.size());
+    size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    putU32(png, crc32(&png[start], png.size() - start));
+}
+
+std::vector<unsigned char> encodePNG(const Canvas& canvas) {
+    std::vector<unsigned char> raw;
+    size_t stride = canvas.width * 3;
+    raw.reserve((stride + 1) * canvas.height);
+    for (int y = 0; y < canvas.height; ++y) {
+        const unsigned char* cur = canvas.row(y);
+        if (y == 0) {
+            raw.push_back(0); // filter: None
+            raw.insert(raw.end(), cur, cur + stride);
+        } else {
+            const unsigned char* above = canvas.row(y - 1);
+            raw.push_back(2); // filter: Up
+            for (size_t x = 0; x < stride; ++x) {
+                raw.push_back(static_cast<unsigned char>(cur[x] - above[x]));
+            }
+        }
+    }
+
+    std::vector<unsigned char> header;
+    putU32(header, canvas.width);
+    putU32(header, canvas.height);
+    header.push_back(8); // bit depth
+    header.push_back(2); // color type: RGB
+    header.push_back(0); // compression
+    header.push_back(0); // filter method
+    header.push_back(0); // no interlace
+
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<unsigned char> png(signature, signature + 8);
+    putChunk(png, "IHDR", header);
+    putChunk(png, "IDAT", zlibCompress(raw));
+    putChunk(png, "IEND", std::vector<unsigned char>());
+    return png;
+}
+
+// ---- SVG backend ----------------------------------------------------------
+
+std::string xmlEscape(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        switch (text[i]) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            case '\'': out += "&apos;"; break;
+            default: out += text[i]; break;
         }
-        file << "\"\n";
     }
-    file.close();
+    return out;
+}
+
+} // namespace
+
+bool PlotUtils::writePNG(const std::vector<PlotLevel>& levels,
+                       const std::string& pngFile,
+                       const std::string& title) {
+    Canvas canvas(kWidth, kHeight, kWhite);
+    int plotBottom = kTop + kPlotHeight;
+
+    // Horizontal grid and y ticks every 10%.
+    for (int pct = 0; pct <= 100; pct += 10) {
+        int y = plotBottom - pct * kPlotHeight / 100;
+        canvas.fillRect(kLeft, y, kLeft + kPlotWidth, y + 1, kGrid);
+        std::ostringstream label;
+        label << pct;
+        canvas.drawText(kLeft - 12 - textWidth(label.str(), 2), y - 7, label.str(), 2, kBlack);
+    }
+
+    std::vector<Bar> bars = layoutBars(levels);
+    int slot = bars.empty() ? kPlotWidth : kPlotWidth / static_cast<int>(bars.size());
+    for (size_t i = 0; i < bars.size(); ++i) {
+        const Bar& bar = bars[i];
+        int cx = (bar.x0 + bar.x1) / 2;
+        canvas.fillRect(bar.x0, bar.top, bar.x1, plotBottom, kBar);
+
+        // Labels shrink, and are eventually dropped, as the bars get narrower.
+        int valueScale = textWidth(bar.value, 2) <= slot ? 2 : 1;
+        if (textWidth(bar.value, valueScale) <= slot) {
+            canvas.drawTextCentered(cx, bar.top - 8 * valueScale - 4, bar.value, valueScale, kBlack);
+        }
+        int tickScale = textWidth(bar.size, 2) <= slot ? 2 : 1;
+        canvas.drawTextCentered(cx, plotBottom + 10, bar.size, tickScale, kBlack);
+        size_t maxChars = static_cast<size_t>(slot / 6);
+        if (maxChars >= 4) {
+            std::string features = bar.features;
+            if (features.size() > maxChars) features = features.substr(0, maxChars - 2) + "..";
+            canvas.drawTextCentered(cx, plotBottom + 34, features, 1, kBlack);
+        }
+    }
+
+    // Axes are drawn last so the bars never cover them.
+    canvas.fillRect(kLeft - 1, kTop, kLeft + 1, plotBottom + 1, kBlack);
+    canvas.fillRect(kLeft - 1, plotBottom - 1, kLeft + kPlotWidth, plotBottom + 1, kBlack);
+
+    canvas.drawTextCentered(kWidth / 2, 30, title, 3, kBlack);
+    canvas.drawTextCentered(kLeft + kPlotWidth / 2, kHeight - 50, "Number of Features", 2, kBlack);
+    std::string yLabel = "Accuracy (%)";
+    canvas.drawTextVertical(30, kTop + kPlotHeight / 2 + textWidth(yLabel, 2) / 2, yLabel, 2, kBlack);
+
+    std::vector<unsigned char> png = encodePNG(canvas);
+    return replaceFile(pngFile, reinterpret_cast<const char*>(&png[0]), png.size());
+}
+
+bool PlotUtils::writeSVG(const std::vector<PlotLevel>& levels,
+                       const std::string& svgFile,
+                       const std::string& title) {
+    int plotBottom = kTop + kPlotHeight;
+    std::ostringstream svg;
+    svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << kWidth << "\" height=\"" << kHeight
+        << "\" viewBox=\"0 0 " << kWidth << " " << kHeight << "\" font-family=\"Arial, sans-serif\">\n";
+    svg << "<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n";
+    svg << "<text x=\"" << kWidth / 2 << "\" y=\"45\" font-size=\"22\" text-anchor=\"middle\">"
+        << xmlEscape(title) << "</text>\n";
+
+    for (int pct = 0; pct <= 100; pct += 10) {
+        int y = plotBottom - pct * kPlotHeight / 100;
+        svg << "<line x1=\"" << kLeft << "\" y1=\"" << y << "\" x2=\"" << kLeft + kPlotWidth << "\" y2=\"" << y
+            << "\" stroke=\"#dcdcdc\"/>\n";
+        svg << "<text x=\"" << kLeft - 10 << "\" y=\"" << y + 5 << "\" font-size=\"14\" text-anchor=\"end\">"
+            << pct << "</text>\n";
+    }
+
+    std::vector<Bar> bars = layoutBars(levels);
+    for (size_t i = 0; i < bars.size(); ++i) {
+        const Bar& bar = bars[i];
+        int cx = (bar.x0 + bar.x1) / 2;
+        svg << "<rect x=\"" << bar.x0 << "\" y=\"" << bar.top << "\" width=\"" << bar.x1 - bar.x0
+            << "\" height=\"" << plotBottom - bar.top << "\" fill=\"#4169E1\" fill-opacity=\"0.8\"/>\n";
+        svg << "<text x=\"" << cx << "\" y=\"" << bar.top - 6 << "\" font-size=\"12\" text-anchor=\"middle\">"
+            << bar.value << "</text>\n";
+        svg << "<text x=\"" << cx << "\" y=\"" << plotBottom + 20 << "\" font-size=\"14\" text-anchor=\"middle\">"
+            << bar.size << "</text>\n";
+        // Feature sets can be long, so they are slanted like rotated gnuplot xtics.
+        svg << "<text x=\"" << cx << "\" y=\"" << plotBottom + 36 << "\" font-size=\"11\" text-anchor=\"end\""
+            << " transform=\"rotate(-45 " << cx << " " << plotBottom + 36 << ")\">"
+            << xmlEscape(bar.features) << "</text>\n";
+    }
+
+    svg << "<line x1=\"" << kLeft << "\" y1=\"" << kTop << "\" x2=\"" << kLeft << "\" y2=\"" << plotBottom
+        << "\" stroke=\"black\" stroke-width=\"2\"/>\n";
+    svg << "<line x1=\"" << kLeft << "\" y1=\"" << plotBottom << "\" x2=\"" << kLeft + kPlotWidth << "\" y2=\""
+        << plotBottom << "\" stroke=\"black\" stroke-width=\"2\"/>\n";
+    svg << "<text x=\"" << kLeft + kPlotWidth / 2 << "\" y=\"" << kHeight - 30
+        << "\" font-size=\"16\" text-anchor=\"middle\">Number of Features</text>\n";
+    svg << "<text x=\"40\" y=\"" << kTop + kPlotHeight / 2 << "\" font-size=\"16\" text-anchor=\"middle\""
+        << " transform=\"rotate(-90 40 " << kTop + kPlotHeight / 2 << ")\">Accuracy (%)</text>\n";
+    svg << "</svg>\n";
+
+    std::string text = svg.str();
+    return replaceFile(svgFile, text.data(), text.size());
+}
+
+std::string PlotUtils::svgFileFor(const std::string& outputFile) {
+    std::string::size_type dot = outputFile.rfind('.');
+    std::string::size_type slash = outputFile.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return outputFile + ".svg";
+    }
+    return outputFile.substr(0, dot) + ".svg";
+}
+
+bool PlotUtils::renderPlot(const std::vector<PlotLevel>& levels,
+                         const std::string& outputFile,
+                         const std::string& title) {
+    bool pngOk = writePNG(levels, outputFile, title);
+    bool svgOk = writeSVG(levels, svgFileFor(outputFile), title);
+    return pngOk && svgOk;
 }
 
-void PlotUtils::plotResults(const std::vector<std::pair<std::vector<int>, double>>& results,
+void PlotUtils::plotResults(const std::vector<PlotLevel>& levels,
                           const std::string& outputFile,
                           const std::string& title) {
-    // Create temporary data file
-    std::string dataFile = "temp_plot_data.txt";
-    writeDataFile(results, dataFile);
-
-    // Create gnuplot script
-    std::ofstream script("plot_script.gp");
-    script << "set terminal pngcairo enhanced font 'Arial,12' size 1200,800\n"
-           << "set output '" << outputFile << "'\n"
-           << "set title '" << title << "' font 'Arial,14'\n"
-           << "set xlabel 'Number of Features' font 'Arial,12'\n"
-           << "set ylabel 'Accuracy (%)' font 'Arial,12'\n"
-           << "set grid\n"
-           << "set key outside right\n"
-           << "set style data histogram\n"
-           << "set style fill solid 0.8\n"
-           << "set boxwidth 0.8\n"
-           << "plot '" << dataFile << "' using 2:xtic(3) title 'Feature Sets' with boxes lc rgb '#4169E1',\\\n"
-           << "     '' using 0:2:2 with labels offset 0,1 notitle\n";
-    script.close();
-
-    // Execute gnuplot
-    std::string command = "gnuplot plot_script.gp";
-    int result = system(command.c_str());
-
-    if (result == 0) {
-        std::cout << "Plot saved as " << outputFile << std::endl;
-        // Clean up temporary files
-        remove(dataFile.c_str());
-        remove("plot_script.gp");
+    if (renderPlot(levels, outputFile, title)) {
+        // stderr, so the message never ends up inside NDJSON/CSV output on stdout.
+        std::cerr << "Plot saved as " << outputFile << " and " << svgFileFor(outputFile) << std::endl;
     } else {
         std::cerr << "Error creating plot" << std::endl;
     }
-} 
\ No newline at end of file
+}
+
+namespace {
+
+// Events only borrow their features, so the sink keeps its own copy.
+PlotLevel levelFor(const SearchEvent& event) {
+    PlotLevel level;
+    level.features.assign(event.features.begin(), event.features.end());
+    level.accuracy = event.accuracy;
+    return level;
+}
+
+} // namespace
+
+const int PlotResultSink::kLiveRedrawSeconds;
+
+PlotResultSink::PlotResultSink(const std::string& outputFile, const std::string& title, bool live)
+    : outputFile(outputFile), title(title), live(live) {}
+
+void PlotResultSink::recordCandidate(const SearchEvent& event) {
+    size_t size = event.features.size();
+    if (size == 0 || event.accuracy < 0) return;
+    if (bestBySize.size() < size) {
+        PlotLevel none;
+        none.accuracy = -1.0;
+        bestBySize.resize(size, none);
+    }
+    PlotLevel& best = bestBySize[size - 1];
+    if (event.accuracy <= best.accuracy) return;
+    best = levelFor(event);
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (!live || now - lastDraw < std::chrono::seconds(kLiveRedrawSeconds)) return;
+    lastDraw = now;
+    levels.clear();
+    for (size_t i = 0; i < bestBySize.size(); ++i) {
+        if (bestBySize[i].accuracy >= 0) levels.push_back(bestBySize[i]);
+    }
+    PlotUtils::renderPlot(levels, outputFile, title);
+}
+
+void PlotResultSink::emit(const SearchEvent& event) {
+    switch (event.type) {
+        case SearchEvent::SearchStarted:
+            // Backward elimination starts from a scored full set; forward starts
+            // empty and exhaustive lists the features to search without a score.
+            levels.clear();
+            bestBySize.clear();
+            lastDraw = std::chrono::steady_clock::now();
+            if (!event.features.empty() && event.accuracy >= 0) levels.push_back(levelFor(event));
+            break;
+        case SearchEvent::CandidateEvaluated:
+            if (event.algorithm == SearchEvent::Exhaustive) recordCandidate(event);
+            break;
+        case SearchEvent::LevelCompleted:
+            if (!bestBySize.empty()) {
+                // The exhaustive search's final per-size results replace the live ones.
+                bestBySize.clear();
+                levels.clear();
+            }
+            levels.push_back(levelFor(event));
+            if (live) PlotUtils::renderPlot(levels, outputFile, title);
+            break;
+        case SearchEvent::SearchFinished:
+            if (!levels.empty()) PlotUtils::plotResults(levels, outputFile, title);
+            break;
+        default:
+            break;
+    }
+}
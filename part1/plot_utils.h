@@ -4,15 +4,58 @@
 #include <vector>
 #include <string>
 #include <utility>
+#include <chrono>
+#include "result_sink.h"
+
+// One bar of a chart: a feature set and its accuracy in [0, 1].
+struct PlotLevel {
+    std::vector<int> features;
+    double accuracy;
+};
 
 class PlotUtils {
 public:
-    static void plotResults(const std::vector<std::pair<std::vector<int>, double>>& results,
+    // Plots one bar per recorded feature set
+    // to outputFile as PNG and next to it as SVG, then reports where they went.
+    static void plotResults(const std::vector<PlotLevel>& levels,
                           const std::string& outputFile,
                           const std::string& title);
+    // Same as plotResults but silent; returns false if either file could not be written.
+    // Each file is written under a unique temporary name and renamed into place,
+    // so viewers never see a half-written chart.
+    static bool renderPlot(const std::vector<PlotLevel>& levels,
+                         const std::string& outputFile,
+                         const std::string& title);
+    static bool writePNG(const std::vector<PlotLevel>& levels,
+                       const std::string& pngFile,
+                       const std::string& title);
+    static bool writeSVG(const std::vector<PlotLevel>& levels,
+                       const std::string& svgFile,
+                       const std::string& title);
+    static std::string svgFileFor(const std::string& outputFile);
+};
+
+// Records the feature set chosen at each level and plots them once the
+// search finishes. In live mode the chart is also redrawn after every level,
+// so it can be watched while a long search is still running. Exhaustive
+// search only reports its levels at the very end, so while it runs the chart
+// shows the best subset of each size seen so far, redrawn at most once per
+// kLiveRedrawSeconds.
+class PlotResultSink : public ResultSink {
+public:
+    static const int kLiveRedrawSeconds = 1;
+
+    PlotResultSink(const std::string& outputFile, const std::string& title, bool live = true);
+    void emit(const SearchEvent& event);
 private:
-    static void writeDataFile(const std::vector<std::pair<std::vector<int>, double>>& results,
-                            const std::string& dataFile);
+    void recordCandidate(const SearchEvent& event);
+
+    std::string outputFile;
+    std::string title;
+    bool live;
+    std::vector<PlotLevel> levels;
+    std::vector<PlotLevel> bestBySize; // exhaustive, until its levels arrive; accuracy -1 if none yet
+    std::chrono::steady_clock::time_point lastDraw;
 };
 
-#endif // PLOT_UTILS_H 
\ No newline at end of file
+#endif // PLOT_UTILS_H
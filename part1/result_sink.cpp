@@ -0,0 +1,371 @@
+#include "result_sink.h"
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+const size_t kFlushThreshold = 64 * 1024;
+
+void writeFeatureSet(std::ostream& os, const FeatureList& features) {
+    os << "{";
+    for (size_t i = 0; i < features.size(); ++i) {
+        os << features[i] + 1 << (i == features.size() - 1 ? "" : ", ");
+    }
+    os << "}";
+}
+
+const char* algorithmName(SearchEvent::Algorithm algorithm) {
+    switch (algorithm) {
+        case SearchEvent::Forward: return "forward";
+        case SearchEvent::Backward: return "backward";
+        case SearchEvent::Exhaustive: return "exhaustive";
+    }
+    return "unknown";
+}
+
+// Copies count features between a linear buffer and a ring starting at start.
+void copyToRing(const int* from, size_t count, std::vector<int>& ring, size_t start) {
+    size_t firstPart = std::min(count, ring.size() - start);
+    std::copy(from, from + firstPart, ring.begin() + start);
+    std::copy(from + firstPart, from + count, ring.begin());
+}
+
+void copyFromRing(const std::vector<int>& ring, size_t start, size_t count, int* to) {
+    size_t firstPart = std::min(count, ring.size() - start);
+    std::copy(ring.begin() + start, ring.begin() + start + firstPart, to);
+    std::copy(ring.begin(), ring.begin() + (count - firstPart), to + firstPart);
+}
+
+const char* eventName(SearchEvent::Type type) {
+    switch (type) {
+        case SearchEvent::SearchAborted: return "search_aborted";
+        case SearchEvent::SearchStarted: return "search_started";
+        case SearchEvent::LevelStarted: return "level_started";
+        case SearchEvent::CandidateEvaluated: return "candidate_evaluated";
+        case SearchEvent::LevelCompleted: return "level_completed";
+        case SearchEvent::SearchHalted: return "search_halted";
+        case SearchEvent::SearchFinished: return "search_finished";
+    }
+    return "unknown";
+}
+
+void writeOut(std::ostream& out, std::string& buffer) {
+    if (!buffer.empty()) {
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    out.flush();
+}
+
+} // namespace
+
+TextResultSink::TextResultSink(std::ostream& out, bool quiet) : out(out), quiet(quiet) {}
+
+TextResultSink::~TextResultSink() {
+    writeOut(out, buffer);
+}
+
+void TextResultSink::emit(const SearchEvent& e) {
+    bool forward = e.algorithm == SearchEvent::Forward;
+    bool exhaustive = e.algorithm == SearchEvent::Exhaustive;
+    std::string name = forward ? "forward selection" : exhaustive ? "exhaustive search" : "backward elimination";
+    std::ostringstream os;
+
+    switch (e.type) {
+        case SearchEvent::SearchAborted:
+            os << "Input data X is empty or has no features. Aborting " << name << ".\n";
+            break;
+        case SearchEvent::SearchStarted:
+            if (exhaustive) {
+                os << "Beginning exhaustive search over all " << (1ULL << e.features.size()) - 1
+                   << " non-empty subsets of ";
+                writeFeatureSet(os, e.features);
+                os << ".\n";
+                break;
+            }
+            if (!forward) {
+                os << "Initial feature set: ";
+                writeFeatureSet(os, e.features);
+                os << " with accuracy " << e.accuracy * 100 << "%\n";
+            }
+            os << "Beginning " << name << ".\n";
+            break;
+        case SearchEvent::LevelStarted:
+            if (quiet) break;
+            os << "\nOn level " << e.level << " of the search tree\n";
+            os << (forward ? "Current selected feature set: " : "Current feature set to evaluate for removal: ");
+            writeFeatureSet(os, e.features);
+            os << "\n";
+            break;
+        case SearchEvent::CandidateEvaluated:
+            if (quiet) break;
+            if (exhaustive) {
+                os << "    Subset ";
+            } else if (forward) {
+                os << "    Considering adding feature " << e.feature + 1 << " with current set ";
+            } else {
+                os << "    Considering removing feature " << e.feature + 1 << ". Remaining set ";
+            }
+            writeFeatureSet(os, e.features);
+            if (e.abandoned) {
+                os << " abandoned, cannot beat the best subset of its size\n";
+            } else {
+                os << " accuracy is " << e.accuracy * 100 << "%\n";
+            }
+            break;
+        case SearchEvent::LevelCompleted:
+            if (exhaustive) {
+                os << (e.level == 1 ? "\n" : "") << "Best subset of size " << e.level << ": ";
+                writeFeatureSet(os, e.features);
+                os << " with accuracy " << e.accuracy * 100 << "%\n";
+                break;
+            }
+            if (forward) {
+                os << "\nOn level " << e.level << ", added feature " << e.feature + 1
+                   << " to current set. Accuracy: " << e.accuracy * 100 << "%\n";
+            } else {
+                os << "\nOn level " << e.level << ", removed feature " << e.feature + 1
+                   << ". Accuracy with remaining features: " << e.accuracy * 100 << "%\n";
+            }
+            os << "Current best feature set: ";
+            writeFeatureSet(os, e.features);
+            os << " with accuracy " << e.accuracy * 100 << "%\n";
+            if (!e.improved) {
+                os << (forward ? "(Warning, accuracy has decreased or stayed the same. Global best is still better.)\n"
+                               : "(Warning, accuracy has decreased. Global best is still better.)\n");
+            }
+            break;
+        case SearchEvent::SearchHalted:
+            if (forward) {
+                os << "\nNo feature improved accuracy at this level. Halting forward selection.\n";
+            } else if (e.features.size() <= 1) {
+                os << "\nOnly one feature remaining. Halting backward elimination.\n";
+            } else {
+                os << "\nCould not determine a feature to remove or no feature removal improved/maintained accuracy. Halting backward elimination.\n";
+            }
+            break;
+        case SearchEvent::SearchFinished:
+            os << "\nFinished " << name << "!! The best feature subset is: ";
+            writeFeatureSet(os, e.features);
+            os << ", which has an accuracy of " << e.accuracy * 100 << "%\n";
+            os << "Scratch memory: " << e.scratchAllocations << " buffers from the arena, "
+               << "peak " << e.scratchPeakBytes << " bytes; " << e.heapAllocations << " heap allocations ("
+               << e.loopHeapAllocations << " while evaluating candidates)\n";
+            if (e.abandonedCandidates > 0) {
+                os << "Stopped scoring " << e.abandonedCandidates << " subsets early\n";
+            }
+            break;
+    }
+
+    buffer += os.str();
+    if (buffer.size() >= kFlushThreshold || e.type == SearchEvent::SearchFinished || e.type == SearchEvent::SearchAborted) {
+        writeOut(out, buffer);
+    }
+}
+
+void TextResultSink::flush() {
+    writeOut(out, buffer);
+}
+
+NdjsonResultSink::NdjsonResultSink(std::ostream& out) : out(out) {}
+
+NdjsonResultSink::~NdjsonResultSink() {
+    writeOut(out, buffer);
+}
+
+void NdjsonResultSink::emit(const SearchEvent& e) {
+    std::ostringstream os;
+    os << std::setprecision(std::numeric_limits<double>::max_digits10);
+    os << "{\"event\":\"" << eventName(e.type) << "\",\"algorithm\":\"" << algorithmName(e.algorithm) << "\"";
+    if (e.level > 0) os << ",\"level\":" << e.level;
+    if (e.feature >= 0) os << ",\"feature\":" << e.feature + 1;
+    os << ",\"features\":[";
+    for (size_t i = 0; i < e.features.size(); ++i) {
+        os << (i == 0 ? "" : ",") << e.features[i] + 1;
+    }
+    os << "]";
+    if (e.accuracy >= 0) os << ",\"accuracy\":" << e.accuracy;
+    if (e.type == SearchEvent::LevelCompleted) os << ",\"improved\":" << (e.improved ? "true" : "false");
+    if (e.abandoned) os << ",\"abandoned\":true";
+    if (e.type == SearchEvent::SearchFinished) {
+        os << ",\"scratch_allocations\":" << e.scratchAllocations
+           << ",\"scratch_peak_bytes\":" << e.scratchPeakBytes
+           << ",\"heap_allocations\":" << e.heapAllocations
+           << ",\"loop_heap_allocations\":" << e.loopHeapAllocations
+           << ",\"abandoned_candidates\":" << e.abandonedCandidates;
+    }
+    os << "}\n";
+
+    buffer += os.str();
+    if (buffer.size() >= kFlushThreshold || e.type == SearchEvent::SearchFinished || e.type == SearchEvent::SearchAborted) {
+        writeOut(out, buffer);
+    }
+}
+
+void NdjsonResultSink::flush() {
+    writeOut(out, buffer);
+}
+
+CsvResultSink::CsvResultSink(std::ostream& out) : out(out), headerWritten(false) {}
+
+CsvResultSink::~CsvResultSink() {
+    writeOut(out, buffer);
+}
+
+void CsvResultSink::emit(const SearchEvent& e) {
+    std::ostringstream os;
+    os << std::setprecision(std::numeric_limits<double>::max_digits10);
+    if (!headerWritten) {
+        os << "event,algorithm,level,feature,features,accuracy,improved,abandoned,"
+           << "scratch_allocations,scratch_peak_bytes,heap_allocations,loop_heap_allocations,abandoned_candidates\n";
+        headerWritten = true;
+    }
+    os << eventName(e.type) << "," << algorithmName(e.algorithm) << ",";
+    if (e.level > 0) os << e.level;
+    os << ",";
+    if (e.feature >= 0) os << e.feature + 1;
+    // Feature sets are space-separated so the field never needs quoting.
+    os << ",";
+    for (size_t i = 0; i < e.features.size(); ++i) {
+        os << (i == 0 ? "" : " ") << e.features[i] + 1;
+    }
+    os << ",";
+    if (e.accuracy >= 0) os << e.accuracy;
+    os << ",";
+    if (e.type == SearchEvent::LevelCompleted) os << (e.improved ? "true" : "false");
+    os << ",";
+    if (e.abandoned) os << "true";
+    if (e.type == SearchEvent::SearchFinished) {
+        os << "," << e.scratchAllocations << "," << e.scratchPeakBytes << "," << e.heapAllocations << ","
+           << e.loopHeapAllocations << "," << e.abandonedCandidates;
+    } else {
+        os << ",,,,,";
+    }
+    os << "\n";
+
+    buffer += os.str();
+    if (buffer.size() >= kFlushThreshold || e.type == SearchEvent::SearchFinished || e.type == SearchEvent::SearchAborted) {
+        writeOut(out, buffer);
+    }
+}
+
+void CsvResultSink::flush() {
+    writeOut(out, buffer);
+}
+
+TeeResultSink::TeeResultSink(const std::vector<ResultSink*>& sinks) : sinks(sinks) {}
+
+void TeeResultSink::emit(const SearchEvent& event) {
+    for (ResultSink* sink : sinks) {
+        sink->emit(event);
+    }
+}
+
+void TeeResultSink::flush() {
+    for (ResultSink* sink : sinks) {
+        sink->flush();
+    }
+}
+
+AsyncResultSink::AsyncResultSink(ResultSink& inner, size_t capacity, size_t featureCapacity)
+    : inner(inner), slots(capacity > 0 ? capacity : 1, SearchEvent(SearchEvent::SearchStarted, SearchEvent::Forward)),
+      head(0), count(0), featureRing(featureCapacity > 0 ? featureCapacity : 1), featureHead(0), featureCount(0),
+      busy(false), stopping(false), failed(false), writer(&AsyncResultSink::run, this) {}
+
+AsyncResultSink::~AsyncResultSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWriter.notify_one();
+    writer.join();
+    // A destructor must not throw; callers that care about errors call flush() first.
+    try {
+        if (!failed) inner.flush();
+    } catch (...) {
+    }
+}
+
+void AsyncResultSink::rethrowError(std::unique_lock<std::mutex>& lock) {
+    if (!error) return;
+    std::exception_ptr e = error;
+    error = std::exception_ptr();
+    lock.unlock();
+    std::rethrow_exception(e);
+}
+
+void AsyncResultSink::emit(const SearchEvent& event) {
+    size_t numFeatures = event.features.size();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        rethrowError(lock);
+        if (failed) return;
+        if (numFeatures > featureRing.size()) {
+            // Could never fit; wait until the writer is idle and grow the ring.
+            drained.wait(lock, [this] { return count == 0 && !busy; });
+            featureRing.resize(numFeatures);
+            featureHead = 0;
+        }
+        notFull.wait(lock, [this, numFeatures] {
+            return count < slots.size() && featureCount + numFeatures <= featureRing.size();
+        });
+        copyToRing(event.features.begin(), numFeatures, featureRing,
+                   (featureHead + featureCount) % featureRing.size());
+        featureCount += numFeatures;
+        slots[(head + count) % slots.size()] = event;
+        ++count;
+    }
+    wakeWriter.notify_one();
+}
+
+void AsyncResultSink::flush() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this] { return count == 0 && !busy; });
+        rethrowError(lock);
+        if (failed) return;
+    }
+    inner.flush();
+}
+
+void AsyncResultSink::run() {
+    SearchEvent current(SearchEvent::SearchStarted, SearchEvent::Forward);
+    std::vector<int> currentFeatures;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeWriter.wait(lock, [this] { return stopping || count > 0; });
+        if (count == 0) break; // stopping and nothing left to write
+
+        // Copy the event out so its slots can be reused while it is written.
+        current = slots[head];
+        size_t numFeatures = current.features.size();
+        currentFeatures.resize(numFeatures);
+        copyFromRing(featureRing, featureHead, numFeatures, currentFeatures.data());
+        current.features = FeatureList(currentFeatures);
+        featureHead = (featureHead + numFeatures) % featureRing.size();
+        featureCount -= numFeatures;
+        head = (head + 1) % slots.size();
+        --count;
+        busy = true;
+        bool dropping = failed;
+        lock.unlock();
+        notFull.notify_all();
+        std::exception_ptr caught;
+        if (!dropping) {
+            try {
+                inner.emit(current);
+            } catch (...) {
+                caught = std::current_exception();
+            }
+        }
+        lock.lock();
+        if (caught) {
+            failed = true;
+            error = caught;
+        }
+        busy = false;
+        if (count == 0) drained.notify_all();
+    }
+}
@@ -0,0 +1,165 @@
+#ifndef RESULT_SINK_H
+#define RESULT_SINK_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <cstddef>
+
+// Feature indices of an event, in ascending order. Points into the emitting
+// search's own storage, so events can be built and copied without touching
+// the heap; it is only valid until emit() returns, and sinks that keep
+// events around must copy the features.
+class FeatureList {
+public:
+    FeatureList() : first(0), count(0) {}
+    FeatureList(const int* first, size_t count) : first(first), count(count) {}
+    explicit FeatureList(const std::vector<int>& features)
+        : first(features.empty() ? 0 : &features[0]), count(features.size()) {}
+
+    const int* begin() const { return first; }
+    const int* end() const { return first + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    int operator[](size_t i) const { return first[i]; }
+private:
+    const int* first;
+    size_t count;
+};
+
+// One step of a feature search, as reported by FeatureSelector.
+// Feature indices are 0-based; sinks print them 1-based like the rest of the app.
+struct SearchEvent {
+    enum Type {
+        SearchAborted,      // input was empty, nothing was evaluated
+        SearchStarted,      // features/accuracy hold the initial set (empty for forward)
+        LevelStarted,       // features holds the set the level starts from
+        CandidateEvaluated, // feature was added/removed, features is the trial set
+        LevelCompleted,     // feature was chosen, features is the new current set
+        SearchHalted,       // no candidate could be chosen at this level
+        SearchFinished      // features/accuracy hold the global best
+    };
+    enum Algorithm { Forward, Backward, Exhaustive };
+
+    Type type;
+    Algorithm algorithm;
+    int level;             // 1-based search tree level (subset size for exhaustive), 0 outside of a level
+    int feature;           // feature added/removed, -1 when not applicable
+    FeatureList features;
+    double accuracy;       // in [0, 1], -1 when not applicable
+    bool improved;         // LevelCompleted: whether the global best was updated
+    bool abandoned;        // CandidateEvaluated: scoring stopped early, accuracy is -1
+
+    // SearchFinished: memory use of the search.
+    size_t scratchAllocations;  // buffers taken from the arena (see Arena)
+    size_t scratchPeakBytes;    // most arena memory in use at once
+    size_t heapAllocations;     // real heap allocations made by the searching thread(s)
+    size_t loopHeapAllocations; // ...of which while evaluating candidates
+    size_t abandonedCandidates; // exhaustive: subsets whose scoring stopped early
+
+    SearchEvent(Type type, Algorithm algorithm)
+        : type(type), algorithm(algorithm), level(0), feature(-1), accuracy(-1.0), improved(false), abandoned(false),
+          scratchAllocations(0), scratchPeakBytes(0), heapAllocations(0), loopHeapAllocations(0),
+          abandonedCandidates(0) {}
+};
+
+class ResultSink {
+public:
+    virtual ~ResultSink() {}
+    virtual void emit(const SearchEvent& event) = 0;
+    // Blocks until everything emitted so far has been written out.
+    virtual void flush() {}
+};
+
+// Human-readable log, buffered in memory and written in large chunks.
+// In quiet mode only level decisions and the final result are printed.
+class TextResultSink : public ResultSink {
+public:
+    explicit TextResultSink(std::ostream& out, bool quiet = false);
+    ~TextResultSink();
+    void emit(const SearchEvent& event);
+    void flush();
+private:
+    std::ostream& out;
+    bool quiet;
+    std::string buffer;
+};
+
+// One JSON object per line, one line per event.
+class NdjsonResultSink : public ResultSink {
+public:
+    explicit NdjsonResultSink(std::ostream& out);
+    ~NdjsonResultSink();
+    void emit(const SearchEvent& event);
+    void flush();
+private:
+    std::ostream& out;
+    std::string buffer;
+};
+
+// One CSV row per event, header written before the first row.
+class CsvResultSink : public ResultSink {
+public:
+    explicit CsvResultSink(std::ostream& out);
+    ~CsvResultSink();
+    void emit(const SearchEvent& event);
+    void flush();
+private:
+    std::ostream& out;
+    std::string buffer;
+    bool headerWritten;
+};
+
+// Forwards every event to each of the given sinks, in order.
+class TeeResultSink : public ResultSink {
+public:
+    explicit TeeResultSink(const std::vector<ResultSink*>& sinks);
+    void emit(const SearchEvent& event);
+    void flush();
+private:
+    std::vector<ResultSink*> sinks;
+};
+
+// Queues events and hands them to the wrapped sink on a background writer
+// thread, so the search does not wait on formatting or I/O. The queue is a
+// fixed ring of `capacity` events, and their features are copied into a
+// second ring with room for `featureCapacity` indices; when the writer falls
+// that far behind, emit() blocks until it catches up. Neither ring grows
+// unless a single event has more features than the whole feature ring, so
+// emit() does not allocate.
+// emit() may be called from several threads at once.
+// If the wrapped sink throws, later events are dropped and the exception is
+// rethrown from the next emit() or flush(), on the calling thread.
+class AsyncResultSink : public ResultSink {
+public:
+    explicit AsyncResultSink(ResultSink& inner, size_t capacity = 4096, size_t featureCapacity = 256 * 1024);
+    ~AsyncResultSink();
+    void emit(const SearchEvent& event);
+    void flush();
+private:
+    void run();
+    void rethrowError(std::unique_lock<std::mutex>& lock);
+
+    ResultSink& inner;
+    std::vector<SearchEvent> slots;
+    size_t head;  // oldest queued event
+    size_t count; // number of queued events
+    std::vector<int> featureRing; // features of the queued events, in queue order
+    size_t featureHead;  // first feature of the oldest queued event
+    size_t featureCount; // number of queued features
+    std::mutex mutex;
+    std::condition_variable wakeWriter;
+    std::condition_variable notFull;
+    std::condition_variable drained;
+    bool busy;
+    bool stopping;
+    bool failed;               // the wrapped sink threw; events are dropped
+    std::exception_ptr error;  // not yet rethrown to a caller
+    std::thread writer;
+};
+
+#endif // RESULT_SINK_H